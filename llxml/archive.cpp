@@ -0,0 +1,291 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: archive.cpp   Author: Dennis Lang  Desc: Read .zip and .gz inputs in memory
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#include "archive.hpp"
+#include "inflate.hpp"
+#include "fileutil.hpp"
+
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+
+static const uint32_t ZIP_LOCAL_SIG = 0x04034b50;
+static const uint32_t ZIP_CENTRAL_SIG = 0x02014b50;
+static const uint32_t ZIP_END_SIG = 0x06054b50;
+static const uint32_t ZIP64_LOCATOR_SIG = 0x07064b50;
+static const uint32_t ZIP64_END_SIG = 0x06064b50;
+static const size_t ZIP_LOCAL_LEN = 30;
+static const size_t ZIP_CENTRAL_LEN = 46;
+static const size_t ZIP_END_LEN = 22;
+static const uint32_t ZIP64_MARK = 0xFFFFFFFF;
+static const uint64_t MAX_INFLATE_RATIO = 1032;    // deflate expands at most 1032 to 1
+
+static const uint8_t GZIP_FHCRC = 2;
+static const uint8_t GZIP_FEXTRA = 4;
+static const uint8_t GZIP_FNAME = 8;
+static const uint8_t GZIP_FCOMMENT = 16;
+
+// -------------------------------------------------------------------------------------------------
+// Little endian fields.
+static uint16_t get16(const uint8_t* ptr) {
+    return (uint16_t)(ptr[0] | (ptr[1] << 8));
+}
+static uint32_t get32(const uint8_t* ptr) {
+    return (uint32_t)get16(ptr) | ((uint32_t)get16(ptr + 2) << 16);
+}
+static uint64_t get64(const uint8_t* ptr) {
+    return (uint64_t)get32(ptr) | ((uint64_t)get32(ptr + 4) << 32);
+}
+
+// -------------------------------------------------------------------------------------------------
+bool Archive::isArchive(const std::string& path) {
+    return FileUtil::hasExtension(path, ".zip") || FileUtil::hasExtension(path, ".gz");
+}
+
+// -------------------------------------------------------------------------------------------------
+bool Archive::open(const std::string& _path) {
+    path = _path;
+    std::ifstream in(path, std::ios::binary);
+    if (in.good()) {
+        in.seekg(0, std::ios::end);
+        data.resize((size_t)in.tellg());
+        in.seekg(0, std::ios::beg);
+        in.read(data.data(), data.size());
+    }
+    if (! in.good()) {
+        openError = strerror(errno) + std::string(", Unable to read archive");
+        return false;
+    }
+
+    gzip = FileUtil::hasExtension(path, ".gz");
+    if (gzip) {
+        const uint8_t* ptr = (const uint8_t*)data.data();
+        if (data.size() < 18 || ptr[0] != 0x1f || ptr[1] != 0x8b || ptr[2] != 8) {
+            openError = "Not a gzip file";
+            return false;
+        }
+        ArchiveEntry entry = ArchiveEntry();
+        entry.name = path.substr(0, path.length() - 3);
+        entry.method = 8;
+        entry.size = get32(ptr + data.size() - 4);      // of the last member
+        entries.push_back(entry);
+        return true;
+    }
+    return indexZip();
+}
+
+// -------------------------------------------------------------------------------------------------
+// List file entries from the central directory, directories are skipped.
+bool Archive::indexZip() {
+    const uint8_t* begPtr = (const uint8_t*)data.data();
+    const uint8_t* endPtr = begPtr + data.size();
+
+    // End of central directory record, followed by a comment of up to 64K.
+    const uint8_t* endRec = nullptr;
+    if (data.size() >= ZIP_END_LEN) {
+        const uint8_t* minPtr = (data.size() > ZIP_END_LEN + 0xFFFF) ? endPtr - ZIP_END_LEN - 0xFFFF : begPtr;
+        for (const uint8_t* ptr = endPtr - ZIP_END_LEN; ptr >= minPtr; ptr--) {
+            if (get32(ptr) == ZIP_END_SIG) {
+                endRec = ptr;
+                break;
+            }
+        }
+    }
+    if (endRec == nullptr) {
+        openError = "Not a zip file";
+        return false;
+    }
+
+    uint64_t count = get16(endRec + 10);
+    uint64_t dirOffset = get32(endRec + 16);
+    if ((count == 0xFFFF || dirOffset == ZIP64_MARK) && endRec - begPtr >= 20
+            && get32(endRec - 20) == ZIP64_LOCATOR_SIG) {
+        uint64_t end64 = get64(endRec - 20 + 8);
+        if (end64 + 56 <= data.size() && get32(begPtr + end64) == ZIP64_END_SIG) {
+            count = get64(begPtr + end64 + 32);
+            dirOffset = get64(begPtr + end64 + 48);
+        }
+    }
+
+    const uint8_t* ptr = begPtr + std::min<uint64_t>(dirOffset, data.size());
+    for (uint64_t idx = 0; idx < count; idx++) {
+        if (endPtr - ptr < (ptrdiff_t)ZIP_CENTRAL_LEN || get32(ptr) != ZIP_CENTRAL_SIG) {
+            openError = "Bad zip central directory";
+            return false;
+        }
+        size_t nameLen = get16(ptr + 28);
+        size_t extraLen = get16(ptr + 30);
+        size_t commentLen = get16(ptr + 32);
+        const uint8_t* namePtr = ptr + ZIP_CENTRAL_LEN;
+        const uint8_t* nextPtr = namePtr + nameLen + extraLen + commentLen;
+        if (nextPtr > endPtr) {
+            openError = "Bad zip central directory";
+            return false;
+        }
+
+        ArchiveEntry entry;
+        entry.name.assign((const char*)namePtr, nameLen);
+        entry.method = get16(ptr + 10);
+        entry.crc = get32(ptr + 16);
+        entry.compSize = get32(ptr + 20);
+        entry.size = get32(ptr + 24);
+        entry.offset = get32(ptr + 42);
+
+        // zip64 extra field holds the values marked 0xFFFFFFFF, in this order
+        for (const uint8_t* extra = namePtr + nameLen; extra + 4 <= namePtr + nameLen + extraLen; ) {
+            uint16_t id = get16(extra);
+            uint16_t len = get16(extra + 2);
+            const uint8_t* field = extra + 4;
+            const uint8_t* fieldEnd = std::min(field + len, namePtr + nameLen + extraLen);
+            if (id == 1) {
+                if (entry.size == ZIP64_MARK && field + 8 <= fieldEnd) { entry.size = get64(field); field += 8; }
+                if (entry.compSize == ZIP64_MARK && field + 8 <= fieldEnd) { entry.compSize = get64(field); field += 8; }
+                if (entry.offset == ZIP64_MARK && field + 8 <= fieldEnd) { entry.offset = get64(field); }
+            }
+            extra += 4 + len;
+        }
+
+        bool encrypted = (get16(ptr + 8) & 1) != 0;
+        if (! entry.name.empty() && entry.name.back() != '/') {
+            if (encrypted)
+                entry.method = 0xFFFF;      // reported on extract
+            entries.push_back(entry);
+        }
+        ptr = nextPtr;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+std::string Archive::entryPath(size_t idx) const {
+    return gzip ? entries[idx].name : path + "/" + entries[idx].name;
+}
+
+// -------------------------------------------------------------------------------------------------
+bool Archive::extract(size_t idx, std::vector<char>& out, std::string& error) const {
+    out.clear();
+    if (! openError.empty() || idx >= entries.size()) {
+        error = openError.empty() ? "No archive entry" : openError;
+        return false;
+    }
+    if (gzip)
+        return extractGzip(out, error);
+
+    const ArchiveEntry& entry = entries[idx];
+    const uint8_t* begPtr = (const uint8_t*)data.data();
+    const uint8_t* endPtr = begPtr + data.size();
+    if (entry.offset + ZIP_LOCAL_LEN > data.size() || get32(begPtr + entry.offset) != ZIP_LOCAL_SIG) {
+        error = "Bad zip local header";
+        return false;
+    }
+    const uint8_t* local = begPtr + entry.offset;
+    const uint8_t* inPtr = local + ZIP_LOCAL_LEN + get16(local + 26) + get16(local + 28);
+    if (inPtr > endPtr || entry.compSize > (uint64_t)(endPtr - inPtr)) {
+        error = "Truncated zip entry";
+        return false;
+    }
+    const uint8_t* inEnd = inPtr + entry.compSize;
+    // The header size is only trusted as far as the compressed data can hold it.
+    if (entry.size > entry.compSize * MAX_INFLATE_RATIO || (entry.method == 0 && entry.size != entry.compSize)) {
+        error = "Bad zip entry size";
+        return false;
+    }
+
+    out.reserve(entry.size + 512);
+    if (entry.method == 0) {
+        out.assign((const char*)inPtr, (const char*)inEnd);
+    } else if (entry.method == 8) {
+        if (! Inflate::raw(inPtr, inEnd, out, error)) {
+            error = "Inflate " + error;
+            return false;
+        }
+    } else {
+        error = (entry.method == 0xFFFF) ? "Encrypted zip entry" : "Unsupported zip method " + std::to_string(entry.method);
+        return false;
+    }
+
+    if (out.size() != entry.size || Inflate::crc32(0, out.data(), out.size()) != entry.crc) {
+        error = "Zip entry size or crc mismatch";
+        return false;
+    }
+    out.push_back('\0');
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Gzip members, concatenated members are one file.
+bool Archive::extractGzip(std::vector<char>& out, std::string& error) const {
+    const uint8_t* ptr = (const uint8_t*)data.data();
+    const uint8_t* endPtr = ptr + data.size();
+    out.reserve(std::min<uint64_t>(entries[0].size, data.size() * MAX_INFLATE_RATIO) + 512);
+
+    while (ptr < endPtr) {
+        if (endPtr - ptr < 18 || ptr[0] != 0x1f || ptr[1] != 0x8b || ptr[2] != 8) {
+            error = "Bad gzip header";
+            return false;
+        }
+        uint8_t flags = ptr[3];
+        ptr += 10;
+        if ((flags & GZIP_FEXTRA) != 0 && endPtr - ptr >= 2)
+            ptr += 2 + get16(ptr);
+        if ((flags & GZIP_FNAME) != 0)
+            while (ptr < endPtr && *ptr++ != 0) {}
+        if ((flags & GZIP_FCOMMENT) != 0)
+            while (ptr < endPtr && *ptr++ != 0) {}
+        if ((flags & GZIP_FHCRC) != 0)
+            ptr += 2;
+        if (ptr >= endPtr) {
+            error = "Truncated gzip file";
+            return false;
+        }
+
+        size_t memberBeg = out.size();
+        if (! Inflate::raw(ptr, endPtr, out, error)) {
+            error = "Inflate " + error;
+            return false;
+        }
+        if (endPtr - ptr < 8
+                || get32(ptr) != Inflate::crc32(0, out.data() + memberBeg, out.size() - memberBeg)
+                || get32(ptr + 4) != (uint32_t)(out.size() - memberBeg)) {
+            error = "Gzip size or crc mismatch";
+            return false;
+        }
+        ptr += 8;
+        while (ptr < endPtr && *ptr == 0)
+            ptr++;      // padding after the last member
+    }
+    out.push_back('\0');
+    return true;
+}
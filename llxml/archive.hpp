@@ -0,0 +1,81 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: archive.hpp   Author: Dennis Lang  Desc: Read .zip and .gz inputs in memory
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// An archive is read once into memory and its entries are inflated straight into parse buffers,
+// on whichever thread parses them, so nothing is extracted to disk. Zip entries are listed from
+// the central directory (zip64 included) and become inputs named archive.zip/dir/name.xml,
+// a .gz file is one entry named as the file without .gz.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct ArchiveEntry {
+    std::string name;       // path inside the archive
+    uint64_t offset;        // zip local header
+    uint64_t compSize;
+    uint64_t size;
+    uint32_t crc;
+    uint16_t method;        // 0 stored, 8 deflate
+};
+
+// Entries can be extracted from several threads at once.
+class Archive {
+public:
+    // True for .zip and .gz paths.
+    static bool isArchive(const std::string& path);
+
+    // Read and index archive, false if it is not a valid archive, see extract().
+    bool open(const std::string& path);
+
+    const std::string& getPath() const { return path; }
+    size_t size() const { return entries.size(); }
+    // Input path of an entry, archive.zip/dir/name.xml or name.xml of name.xml.gz
+    std::string entryPath(size_t idx) const;
+
+    // Inflate entry into out, NUL terminated as a read file. Error is also set if open failed.
+    bool extract(size_t idx, std::vector<char>& out, std::string& error) const;
+
+private:
+    std::string path;
+    std::string openError;
+    std::vector<char> data;
+    std::vector<ArchiveEntry> entries;
+    bool gzip = false;
+
+    bool indexZip();
+    bool extractGzip(std::vector<char>& out, std::string& error) const;
+};
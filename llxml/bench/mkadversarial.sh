@@ -0,0 +1,83 @@
+#!/bin/sh
+# Generate the pathological inputs of the parser scaling check, see bench/scaling.sh.
+# Each case grows with scale, a linear parser takes scale times as long.
+#
+#   sh bench/mkadversarial.sh <dir> <scale>
+#   <dir>/value-<scale>.xml      one <string> with a value of scale MB
+#   <dir>/nested-<scale>.xml     one <string> with tags nested scale*100000 deep
+#   <dir>/comment-<scale>.xml    comment left open before scale MB of text and tags
+#   <dir>/attrs-<scale>.xml      scale*20 strings of 5000 attributes each
+#   <dir>/open-<scale>.xml       scale*40000 comments, headers and strings left open
+
+dir=${1:-obj/bench}
+scale=${2:-1}
+mkdir -p "$dir"
+
+awk -v dir="$dir" -v scale="$scale" '
+function head(f) {
+    print "<?xml version=\"1.0\" encoding=\"utf-8\"?>" > f
+    print "<resources>" > f
+    print "    <string name=\"first\">First</string>" > f
+}
+function tail(f) {
+    print "    <string name=\"last\">Last</string>" > f
+    print "</resources>" > f
+    close(f)
+}
+BEGIN {
+    line = "the quick brown fox jumps over the lazy dog &amp; %1$s \\\x27quoted\\\x27 text\n"
+
+    f = dir "/value-" scale ".xml"
+    head(f)
+    printf "    <string name=\"value\">" > f
+    for (i = int(scale * 1048576 / length(line)); i > 0; i--)
+        printf "%s", line > f
+    print "</string>" > f
+    tail(f)
+
+    f = dir "/nested-" scale ".xml"
+    head(f)
+    printf "    <string name=\"nested\">" > f
+    for (i = 0; i < scale * 100000; i++)
+        printf "<b>" > f
+    printf "deep" > f
+    for (i = 0; i < scale * 100000; i++)
+        printf "</b>" > f
+    print "</string>" > f
+    tail(f)
+
+    f = dir "/comment-" scale ".xml"
+    head(f)
+    print "    <!-- comment without its end" > f
+    text = "    text of a comment < with > tags <b> and -- dashes\n"
+    for (i = int(scale * 1048576 / length(text)); i > 0; i--) {
+        printf "%s", text > f
+        if (i % 500 == 0)
+            print "    <string name=\"key_" i "\">Value " i "</string>" > f
+    }
+    print "</resources>" > f
+    close(f)
+
+    f = dir "/attrs-" scale ".xml"
+    head(f)
+    for (s = 0; s < scale * 20; s++) {
+        printf "    <string" > f
+        for (i = 0; i < 5000; i++)
+            printf " a%d=\"v%d\"", i, i > f
+        print " name=\"attrs_" s "\">Attributes</string>" > f
+    }
+    tail(f)
+
+    f = dir "/open-" scale ".xml"
+    head(f)
+    for (i = 0; i < scale * 40000; i++) {
+        if (i % 3 == 0)
+            print "    <!-- open " i ">" > f
+        else if (i % 3 == 1)
+            print "    <? open " i ">" > f
+        else
+            print "    <string name=\"open_" i "\">open " i ">" > f
+    }
+    print "</resources>" > f
+    close(f)
+}'
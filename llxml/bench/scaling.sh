@@ -0,0 +1,43 @@
+#!/bin/bash
+# Check the parser runs in linear time on the pathological inputs of bench/mkadversarial.sh.
+# Each case is merged into itself at scale 1, 2, 4 and 8, best of 3 runs. Fails if a run
+# crashes or the 8x input takes more than 12x the time of the 1x input.
+#
+#   bash bench/scaling.sh <llxml> [dir]
+
+bin=$1
+dir=${2:-obj/bench}
+SCALES="1 2 4 8"
+LIMIT=12
+TIMEFORMAT=%R
+status=0
+
+for scale in $SCALES; do
+    [ -f "$dir/open-$scale.xml" ] || sh bench/mkadversarial.sh "$dir" $scale
+done
+
+printf "%-8s %8s %8s %8s %8s %8s\n" case 1x 2x 4x 8x ratio
+for name in value nested comment attrs open; do
+    times=""
+    for scale in $SCALES; do
+        file=$dir/$name-$scale.xml
+        secs=""
+        for run in 1 2 3; do
+            t=$( { time "$bin" -outFmt="$dir/out/%n" "$file" , "$file" > /dev/null 2>&1 ; } 2>&1 )
+            code=$?
+            if [ $code -ge 126 ]; then
+                echo "$name-$scale failed to run or crashed, exit $code"
+                exit 1
+            fi
+            secs=$(echo "$secs $t" | awk '{ m = $1; for (i = 2; i <= NF; i++) if ($i < m) m = $i; print m }')
+        done
+        times="$times $secs"
+    done
+    ratio=$(echo $times | awk '{ print ($1 > 0.001 ? $4 / $1 : $4 / 0.001) }')
+    printf "%-8s %8s %8s %8s %8s %7.1fx\n" $name $times $ratio
+    if [ "$(echo $ratio $LIMIT | awk '{ print ($1 > $2) }')" = 1 ]; then
+        echo "$name grows faster than linear, 8x input took ${ratio}x"
+        status=1
+    fi
+done
+exit $status
@@ -0,0 +1,54 @@
+#!/bin/bash
+# Time exec to exit of llxml on trivial jobs against the startup budget.
+# Each job runs 200 times in a batch, best of 5 batches. /bin/true is the cost of
+# starting any process from the shell, the floor under the llxml times.
+#
+#   bash bench/startup.sh <llxml> [dir] [budget ms]
+
+bin=$1
+dir=${2:-obj/bench}
+budget=${3:-1.0}
+RUNS=200
+TIMEFORMAT=%R
+status=0
+
+mkdir -p "$dir"
+cat > "$dir/one.xml" <<EOF
+<?xml version="1.0" encoding="utf-8"?>
+<resources>
+    <string name="title">Title</string>
+</resources>
+EOF
+
+# Milliseconds per run of the command, best of 5 batches.
+perRun() {
+    local best=""
+    for batch in 1 2 3 4 5; do
+        t=$( { time for ((run = 0; run < RUNS; run++)); do "$@" > /dev/null 2>&1; done ; } 2>&1 )
+        best=$(echo "$best $t" | awk '{ m = $1; for (i = 2; i <= NF; i++) if ($i < m) m = $i; print m }')
+    done
+    echo "$best $RUNS" | awk '{ printf "%.2f", $1 * 1000 / $2 }'
+}
+
+if ! "$bin" -outFmt="$dir/out/%n" "$dir/one.xml" , "$dir/one.xml" > /dev/null 2>&1; then
+    echo "$bin failed the one file job"
+    exit 1
+fi
+
+floor=$(perRun /bin/true)
+printf "%-10s %8s %8s\n" job ms "over true"
+printf "%-10s %8s\n" true $floor
+for job in empty one-file; do
+    if [ $job = empty ]; then
+        ms=$(perRun "$bin")
+    else
+        ms=$(perRun "$bin" -outFmt="$dir/out/%n" "$dir/one.xml" , "$dir/one.xml")
+    fi
+    over=$(echo "$ms $floor" | awk '{ printf "%.2f", $1 - $2 }')
+    printf "%-10s %8s %8s\n" $job $ms $over
+    if [ "$(echo $ms $budget | awk '{ print ($1 > $2) }')" = 1 ]; then
+        echo "$job job takes $ms ms, over the $budget ms budget"
+        status=1
+    fi
+done
+exit $status
@@ -0,0 +1,155 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: csvwriter.cpp   Author: Dennis Lang  Desc: Buffered CSV/TSV writer
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#include "csvwriter.hpp"
+#include "fileutil.hpp"
+
+#include <iostream>
+#include <stdio.h>
+
+static const size_t FLUSH_SIZE = 1024 * 1024;
+
+// -------------------------------------------------------------------------------------------------
+CsvWriter::CsvWriter(char _separator) : separator(_separator) {
+    buffer.reserve(FLUSH_SIZE + 64 * 1024);
+}
+
+CsvWriter::~CsvWriter() {
+    close();
+}
+
+// -------------------------------------------------------------------------------------------------
+char CsvWriter::separatorFor(const std::string& path) {
+    if (FileUtil::hasExtension(path, ".tsv"))
+        return '\t';
+    return ',';
+}
+
+// -------------------------------------------------------------------------------------------------
+bool CsvWriter::open(const std::string& path) {
+    if (path == "-") {
+        out = &std::cout;
+    } else {
+        outF.open(FileUtil::tempPath(path), std::ios::binary);
+        if (! outF.is_open())
+            return false;
+        outPath = path;
+        out = &outF;
+    }
+    rowStart = true;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+// CSV  quote if the field has a separator, quote or line break, quotes are doubled.
+// TSV  tab, newline, carriage return and backslash are backslash escaped, as \t and \n.
+void CsvWriter::field(const char* str, size_t len) {
+    if (! rowStart)
+        buffer += separator;
+    rowStart = false;
+
+    const char* end = str + len;
+    if (separator == '\t') {
+        const char* run = str;
+        for (const char* ptr = str; ptr != end; ptr++) {
+            char esc;
+            switch (*ptr) {
+            case '\t': esc = 't'; break;
+            case '\n': esc = 'n'; break;
+            case '\r': esc = 'r'; break;
+            case '\\': esc = '\\'; break;
+            default:   continue;
+            }
+            buffer.append(run, ptr - run);
+            buffer += '\\';
+            buffer += esc;
+            run = ptr + 1;
+        }
+        buffer.append(run, end - run);
+    } else {
+        const char* ptr = str;
+        while (ptr != end && *ptr != separator && *ptr != '"' && *ptr != '\n' && *ptr != '\r')
+            ptr++;
+        if (ptr == end) {
+            buffer.append(str, len);
+        } else {
+            buffer += '"';
+            const char* run = str;
+            for (ptr = str; ptr != end; ptr++) {
+                if (*ptr == '"') {
+                    buffer.append(run, ptr - run + 1);
+                    buffer += '"';
+                    run = ptr + 1;
+                }
+            }
+            buffer.append(run, end - run);
+            buffer += '"';
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+void CsvWriter::endRow() {
+    buffer += '\n';
+    rowStart = true;
+    if (buffer.size() >= FLUSH_SIZE)
+        flush();
+}
+
+// -------------------------------------------------------------------------------------------------
+void CsvWriter::flush() {
+    if (out != nullptr && ! buffer.empty())
+        out->write(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+// -------------------------------------------------------------------------------------------------
+bool CsvWriter::close() {
+    if (out == nullptr)
+        return true;
+    flush();
+    out->flush();
+    bool ok = out->good();
+    out = nullptr;
+    if (outF.is_open()) {
+        outF.close();
+        std::string tmpPath = FileUtil::tempPath(outPath);
+        if (! ok || outF.fail()) {
+            remove(tmpPath.c_str());
+            return false;
+        }
+        return FileUtil::renameOver(tmpPath, outPath);
+    }
+    return ok;
+}
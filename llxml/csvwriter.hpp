@@ -0,0 +1,73 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: csvwriter.hpp   Author: Dennis Lang  Desc: Buffered CSV/TSV writer
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// Rows are built field by field in a large buffer and written in blocks. CSV fields are quoted
+// when needed (RFC 4180), TSV fields escape tab, newline and backslash, so multi-line values
+// stay one field either way.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#pragma once
+
+#include <fstream>
+#include <string>
+
+class CsvWriter {
+public:
+    explicit CsvWriter(char _separator = ',');
+    ~CsvWriter();
+
+    // Tab separated if path ends with .tsv, "-" is stdout.
+    static char separatorFor(const std::string& path);
+
+    bool open(const std::string& path);
+    void field(const char* str, size_t len);
+    void field(const std::string& str) {
+        field(str.data(), str.length());
+    }
+    void endRow();
+    // Flush and close, false if any write failed. A file is only replaced if all writes succeed.
+    bool close();
+
+private:
+    std::ofstream outF;
+    std::string outPath;        // renamed over when closed
+    std::ostream* out = nullptr;
+    std::string buffer;
+    char separator;
+    bool rowStart = true;
+
+    void flush();
+
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+};
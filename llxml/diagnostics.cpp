@@ -0,0 +1,191 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: diagnostics.cpp   Author: Dennis Lang  Desc: Buffered diagnostics sink
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "diagnostics.hpp"
+
+#include <ctype.h>
+#include <stdio.h>
+
+static const size_t FLUSH_SIZE = 64 * 1024;
+
+static const char* const CATEGORY_NAMES[DIAG_CATEGORIES] = {
+    "error", "duplicate", "extra", "output", "info"
+};
+
+static bool isWarning(DiagCategory category) {
+    return category == DIAG_DUPLICATE || category == DIAG_EXTRA;
+}
+
+// -------------------------------------------------------------------------------------------------
+Diagnostics::Diagnostics(std::ostream& _out) : out(_out) {
+    buffer.reserve(FLUSH_SIZE + 1024);
+}
+
+Diagnostics::~Diagnostics() {
+    flush();
+}
+
+// -------------------------------------------------------------------------------------------------
+bool Diagnostics::accept(DiagCategory category) {
+    if (maxWarnings != 0 && isWarning(category) && counts[category] >= maxWarnings) {
+        counts[category]++;
+        suppressed[category]++;
+        return false;
+    }
+    counts[category]++;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Text is the message as is, json is {"category":"extra","file":"...","key":"...","message":"..."}
+void Diagnostics::write(DiagCategory category, const std::string& file, const std::string& key,
+    const std::string& message) {
+    if (json) {
+        buffer += "{\"category\":\"";
+        buffer += CATEGORY_NAMES[category];
+        buffer += "\",\"file\":";
+        appendJson(buffer, file);
+        if (! key.empty()) {
+            buffer += ",\"key\":";
+            appendJson(buffer, key);
+        }
+        buffer += ",\"message\":";
+        appendJson(buffer, message);
+        if (ordered)
+            buffer += ",\"order\":" + std::to_string(order);
+        buffer += "}\n";
+    } else {
+        buffer += message;
+        buffer += '\n';
+    }
+    if (buffer.size() >= FLUSH_SIZE)
+        flush();
+}
+
+// -------------------------------------------------------------------------------------------------
+void Diagnostics::stats(const std::string& name, const std::vector<std::pair<std::string, uint64_t>>& values,
+        const char* category) {
+    if (json) {
+        buffer += "{\"category\":\"" + std::string(category) + "\",\"name\":";
+        appendJson(buffer, name);
+        for (const auto& value : values)
+            buffer += ",\"" + value.first + "\":" + std::to_string(value.second);
+        buffer += "}\n";
+    } else {
+        buffer += (char)toupper(category[0]) + std::string(category + 1) + " " + name + ":";
+        for (const auto& value : values)
+            buffer += " " + value.first + "=" + std::to_string(value.second);
+        buffer += "\n";
+    }
+    flush();
+}
+
+// -------------------------------------------------------------------------------------------------
+bool Diagnostics::categoryOf(const std::string& name, DiagCategory& category) {
+    for (size_t cat = 0; cat < DIAG_CATEGORIES; cat++) {
+        if (name == CATEGORY_NAMES[cat]) {
+            category = (DiagCategory)cat;
+            return true;
+        }
+    }
+    return false;
+}
+
+// -------------------------------------------------------------------------------------------------
+void Diagnostics::summary(bool verbose) {
+    size_t suppressedCnt = 0;
+    for (size_t cat = 0; cat < DIAG_CATEGORIES; cat++)
+        suppressedCnt += suppressed[cat];
+    if (suppressedCnt == 0 && ! verbose)
+        return;
+
+    std::string counted;
+    std::string dropped;
+    for (size_t cat = 0; cat < DIAG_CATEGORIES; cat++) {
+        std::string name = CATEGORY_NAMES[cat];
+        if (json) {
+            counted += (counted.empty() ? "" : ",") + ("\"" + name + "\":" + std::to_string(counts[cat]));
+            if (suppressed[cat] != 0)
+                dropped += (dropped.empty() ? "" : ",") + ("\"" + name + "\":" + std::to_string(suppressed[cat]));
+        } else {
+            counted += " " + name + "=" + std::to_string(counts[cat]);
+            if (suppressed[cat] != 0)
+                dropped += " " + name + "=" + std::to_string(suppressed[cat]);
+        }
+    }
+
+    if (json) {
+        buffer += "{\"category\":\"summary\",\"counts\":{" + counted + "}";
+        buffer += ",\"suppressed\":{" + dropped + "}";
+        buffer += ",\"maxWarnings\":" + std::to_string(maxWarnings) + "}\n";
+    } else {
+        if (suppressedCnt != 0)
+            buffer += "Suppressed warnings (-maxWarnings=" + std::to_string(maxWarnings) + "):" + dropped + "\n";
+        if (verbose)
+            buffer += "Diagnostics:" + counted + "\n";
+    }
+    flush();
+}
+
+// -------------------------------------------------------------------------------------------------
+void Diagnostics::flush() {
+    if (! buffer.empty()) {
+        out.write(buffer.data(), buffer.size());
+        out.flush();
+        buffer.clear();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+void Diagnostics::appendJson(std::string& buf, const std::string& str) {
+    buf += '"';
+    for (unsigned char c : str) {
+        switch (c) {
+        case '"':  buf += "\\\""; break;
+        case '\\': buf += "\\\\"; break;
+        case '\n': buf += "\\n"; break;
+        case '\r': buf += "\\r"; break;
+        case '\t': buf += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                char hex[8];
+                snprintf(hex, sizeof(hex), "\\u%04x", c);
+                buf += hex;
+            } else {
+                buf += (char)c;
+            }
+            break;
+        }
+    }
+    buf += '"';
+}
@@ -0,0 +1,112 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: diagnostics.hpp   Author: Dennis Lang  Desc: Buffered diagnostics sink
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// Warnings, errors and progress messages are collected in one buffer and written to stderr
+// in large blocks instead of a flushed line each. Every message is counted by category,
+// -maxWarnings caps how many warnings of each category are output and -diag=json writes
+// one JSON object per message for tools.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum DiagCategory {
+    DIAG_ERROR,         // parse and read failures
+    DIAG_DUPLICATE,     // key with different values
+    DIAG_EXTRA,         // child key not found in any master
+    DIAG_OUTPUT,        // output file results
+    DIAG_INFO,          // verbose progress
+    DIAG_CATEGORIES
+};
+
+// One message, collected where it can not be output yet (worker threads).
+struct Diagnostic {
+    DiagCategory category;
+    std::string file;
+    std::string key;
+    std::string message;
+};
+
+// Not thread safe, report from one thread and flush before writing to stdout.
+class Diagnostics {
+public:
+    bool json = false;
+    unsigned maxWarnings = 0;   // per warning category, 0 is no limit
+
+    // With -shard json lines carry an order, so shard reports combine in the order of one run:
+    // input number while merging, OUTPUT_ORDER + master number while writing, then TAIL_ORDER.
+    bool ordered = false;
+    uint64_t order = 0;
+    static const uint64_t OUTPUT_ORDER = 1ull << 40;
+    static const uint64_t TAIL_ORDER = 1ull << 41;
+
+    explicit Diagnostics(std::ostream& out);
+    ~Diagnostics();
+
+    // Count a message, false if it is over the warning limit and need not be built.
+    bool accept(DiagCategory category);
+    // Output an accepted message.
+    void write(DiagCategory category, const std::string& file, const std::string& key, const std::string& message);
+
+    void report(DiagCategory category, const std::string& file, const std::string& key, const std::string& message) {
+        if (accept(category))
+            write(category, file, key, message);
+    }
+    void report(const Diagnostic& diag) {
+        report(diag.category, diag.file, diag.key, diag.message);
+    }
+
+    // Named totals, as {"category":"stats","name":"1/4","updates":10} or Stats 1/4: updates=10
+    void stats(const std::string& name, const std::vector<std::pair<std::string, uint64_t>>& values,
+            const char* category = "stats");
+    // Suppressed warning counts, and all counts if verbose.
+    void summary(bool verbose);
+    void flush();
+
+    size_t count(DiagCategory category) const { return counts[category]; }
+    static bool categoryOf(const std::string& name, DiagCategory& category);
+
+private:
+    std::ostream& out;
+    std::string buffer;
+    size_t counts[DIAG_CATEGORIES] = {};
+    size_t suppressed[DIAG_CATEGORIES] = {};
+
+    static void appendJson(std::string& buf, const std::string& str);
+
+    Diagnostics(const Diagnostics&) = delete;
+    Diagnostics& operator=(const Diagnostics&) = delete;
+};
@@ -73,6 +73,13 @@ Directory_files::Directory_files(const lstring& dirName) :
     my_dirName(dirName) {
 }
 
+//-------------------------------------------------------------------------------------------------
+Directory_files::Directory_files(const Directory_files& parent, const char* name) :
+    my_dir_hnd(INVALID_HANDLE_VALUE),
+    my_dirName(parent.my_dirName + SLASH + name) {
+    GetFullPath(my_dirName);
+}
+
 //-------------------------------------------------------------------------------------------------
 Directory_files::~Directory_files() {
     if (my_dir_hnd != INVALID_HANDLE_VALUE)
@@ -157,6 +164,128 @@ const lstring& Directory_files::fullName(lstring& fname) const {
     return GetFullPath(fname);
 }
 
+#elif defined(__linux__)
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+const lstring Directory_files::SLASH = "/";
+const char Directory_files::SLASH_CHAR = '/';
+const lstring Directory_files::SLASH2 = "//";
+
+// Record layout returned by getdents64
+struct LinuxDirent64 {
+    uint64_t        d_ino;
+    int64_t         d_off;
+    unsigned short  d_reclen;
+    unsigned char   d_type;
+    char            d_name[1];
+};
+static const size_t DIRENT_BUF_SIZE = 32 * 1024;
+
+//-------------------------------------------------------------------------------------------------
+Directory_files::Directory_files(const lstring& dirName) :
+    my_fd(-1), my_buf(NULL), my_bufLen(0), my_bufPos(0),
+    my_name(NULL), my_type(DT_UNKNOWN), my_baseLen(0) {
+    lstring baseDir = dirName;
+    if (!DirUtil::fileExists(dirName)) {
+        // Remove any wildcard are extra characters.
+        DirUtil::getDir(baseDir, dirName);
+    }
+    if (realpath(baseDir.c_str(), my_fullname) != NULL) {
+        openAt(AT_FDCWD, my_fullname);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+Directory_files::Directory_files(const Directory_files& parent, const char* name) :
+    my_fd(-1), my_buf(NULL), my_bufLen(0), my_bufPos(0),
+    my_name(NULL), my_type(DT_UNKNOWN), my_baseLen(0) {
+    size_t nameLen = strlen(name);
+    if (parent.my_fd >= 0 && parent.my_baseLen + nameLen + 2 <= sizeof(my_fullname)) {
+        memcpy(my_fullname, parent.my_fullname, parent.my_baseLen);
+        memcpy(my_fullname + parent.my_baseLen, name, nameLen + 1);
+        openAt(parent.my_fd, name);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Open directory relative to dirFd, my_fullname holds its path.
+void Directory_files::openAt(int dirFd, const char* dirName) {
+    my_fd = openat(dirFd, dirName, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (my_fd >= 0) {
+        my_buf = new char[DIRENT_BUF_SIZE];
+        my_baseLen = strlen(my_fullname);
+        if (my_baseLen == 0 || my_fullname[my_baseLen - 1] != SLASH_CHAR)
+            my_fullname[my_baseLen++] = SLASH_CHAR;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+Directory_files::~Directory_files() {
+    close();
+    delete [] my_buf;
+}
+
+//-------------------------------------------------------------------------------------------------
+void Directory_files::close() {
+    if (my_fd >= 0) {
+        ::close(my_fd);
+        my_fd = -1;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+bool Directory_files::more() {
+    while (my_fd >= 0) {
+        if (my_bufPos >= my_bufLen) {
+            long len = syscall(SYS_getdents64, my_fd, my_buf, DIRENT_BUF_SIZE);
+            if (len <= 0) {
+                close();
+                break;
+            }
+            my_bufLen = (size_t)len;
+            my_bufPos = 0;
+        }
+
+        const LinuxDirent64* pDirEnt = (const LinuxDirent64*)(my_buf + my_bufPos);
+        my_bufPos += pDirEnt->d_reclen;
+        my_name = pDirEnt->d_name;
+        my_type = pDirEnt->d_type;
+
+        // Skip dot directories
+        if (!(my_name[0] == '.' && ! isalnum(my_name[1]) && is_directory()))
+            return true;
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool Directory_files::is_directory() const {
+    if (my_type == DT_UNKNOWN) {
+        struct stat filestat;
+        bool isDir = fstatat(my_fd, my_name, &filestat, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(filestat.st_mode);
+        my_type = isDir ? DT_DIR : DT_REG;
+    }
+    return my_type == DT_DIR;
+}
+
+//-------------------------------------------------------------------------------------------------
+const char* Directory_files::name() const {
+    return my_name;
+}
+
+//-------------------------------------------------------------------------------------------------
+const lstring& Directory_files::fullName(lstring& fname) const {
+    fname.assign(my_fullname, my_baseLen);
+    fname.append(my_name);
+    return fname;
+}
+
 #else
 
 #include <unistd.h>
@@ -166,6 +295,11 @@ const lstring Directory_files::SLASH = "/";
 const char Directory_files::SLASH_CHAR = '/';
 const lstring Directory_files::SLASH2 = "//";
 
+//-------------------------------------------------------------------------------------------------
+Directory_files::Directory_files(const Directory_files& parent, const char* name) :
+    Directory_files(parent.my_baseDir + SLASH + name) {
+}
+
 //-------------------------------------------------------------------------------------------------
 Directory_files::Directory_files(const lstring& dirName) {
     if (!DirUtil::fileExists(dirName)) {
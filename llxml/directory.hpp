@@ -59,8 +59,11 @@
 
     #include <sys/types.h>
     #include <sys/stat.h>
+    #ifdef __APPLE__
     #include <sys/dirent.h>
+    #endif
     #include <dirent.h>
+    #include <strings.h>    // strncasecmp
     #include <unistd.h>
     #include <limits.h>
 
@@ -92,6 +95,8 @@ typedef void* HANDLE;
 class Directory_files {
 public:
     Directory_files(const lstring& dirName);
+    // Open subdirectory name of parent's current entry.
+    Directory_files(const Directory_files& parent, const char* name);
     ~Directory_files();
 
     // Start at beginning of directory, return true if any files.
@@ -124,6 +129,19 @@ private:
 
     HANDLE      my_dir_hnd;     // Search handle returned by FindFirstFile
     lstring     my_dirName;     // Directory name
+#elif defined(__linux__)
+    // Entries are read in getdents64 batches from a directory fd, subdirectories
+    // are opened relative to it and paths are built behind the my_fullname prefix.
+    int         my_fd;
+    char*       my_buf;             // getdents64 batch
+    size_t      my_bufLen;
+    size_t      my_bufPos;
+    const char* my_name;            // current entry
+    mutable unsigned char my_type;  // d_type, DT_UNKNOWN resolved on demand
+    size_t      my_baseLen;         // length of "dir/" prefix
+    char        my_fullname[PATH_MAX];
+
+    void openAt(int dirFd, const char* dirName);
 #else
     bool        my_is_more;
     DIR*        my_pDir;
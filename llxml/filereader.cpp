@@ -0,0 +1,379 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: filereader.cpp   Author: Dennis Lang  Desc: Batched file reads
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// Resource trees hold many small files, reading them one stat/open/read/close at a time
+// is syscall and latency bound. On Linux a batch is submitted to io_uring: statx+openat
+// for all files, then reads, each file is handed on as soon as its read completes.
+// Without io_uring (other systems, old kernels, blocked by seccomp) files are read
+// one by one with blocking calls.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "filereader.hpp"
+#include "archive.hpp"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#if defined(__linux__) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>)
+        #include <fcntl.h>
+        #include <linux/io_uring.h>
+        #include <sys/mman.h>
+        #include <sys/syscall.h>
+        #include <unistd.h>
+        // statx, openat and close ops and the probe came with Linux 5.6
+        #if defined(IORING_FEAT_RW_CUR_POS) && defined(STATX_SIZE)
+            #define HAVE_IO_URING
+        #endif
+    #endif
+#endif
+
+// -------------------------------------------------------------------------------------------------
+void FileReader::readFile(XmlFile& file) {
+    ostringstream err;
+    ifstream in;
+    struct stat filestat;
+
+    try {
+        if (file.archive != nullptr) {
+            string error;
+            file.found = true;
+            file.read = file.archive->extract(file.entryIdx, file.buffer, error);
+            if (! file.read)
+                err << "Error - " << error << ", In: " << file.filePath << endl;
+        } else if (stat(file.filePath.c_str(), &filestat) != 0) {
+            err << "Error - empty or not a file: " << file.filePath << endl;
+        } else {
+            file.found = true;
+            in.open(file.filePath);
+            if (in.good()) {
+                XmlBuffer& buffer = file.buffer;
+                buffer.resize(filestat.st_size + 1);
+                streamsize inCnt = in.read(buffer.data(), buffer.size()).gcount();
+                assert(inCnt < buffer.size());
+                in.close();
+                buffer.push_back('\0');
+                file.read = true;
+            } else {
+                err << strerror(errno) << ", Unable to open: " << file.filePath << endl;
+            }
+        }
+    } catch (exception ex) {
+        err << ex.what() << ", Error in file: " << file.filePath << endl;
+    }
+    file.log = err.str();
+}
+
+#ifdef HAVE_IO_URING
+
+// -------------------------------------------------------------------------------------------------
+// Minimal io_uring on the raw kernel interface, no liburing dependency.
+struct FileReader::Ring {
+    int fd = -1;
+    unsigned entries = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0;
+    io_uring_sqe* sqes = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+    unsigned sqeTail = 0;       // queued, published to sqTail by submit
+    unsigned toSubmit = 0;
+
+    void* sqMap = MAP_FAILED;
+    size_t sqMapLen = 0;
+    void* cqMap = MAP_FAILED;
+    size_t cqMapLen = 0;
+    void* sqeMap = MAP_FAILED;
+    size_t sqeMapLen = 0;
+
+    bool setup(unsigned ringSize);
+    ~Ring();
+
+    io_uring_sqe* nextSqe(uint8_t opcode, uint64_t userData);
+    void submit(unsigned waitCnt);
+    bool popCqe(io_uring_cqe& cqe);
+    void readBatch(XmlFile* const* files, size_t cnt, const std::function<void(XmlFile&)>& done);
+};
+
+bool FileReader::Ring::setup(unsigned ringSize) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    fd = (int)syscall(__NR_io_uring_setup, ringSize, &params);
+    if (fd < 0)
+        return false;
+
+    vector<char> probeBuf(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = (io_uring_probe*)probeBuf.data();
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) < 0)
+        return false;
+    for (unsigned op : { IORING_OP_STATX, IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE }) {
+        if (op > probe->last_op || (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0)
+            return false;
+    }
+
+    sqMapLen = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    sqMap = mmap(nullptr, sqMapLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    cqMapLen = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    cqMap = mmap(nullptr, cqMapLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    sqeMapLen = params.sq_entries * sizeof(io_uring_sqe);
+    sqeMap = mmap(nullptr, sqeMapLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqMap == MAP_FAILED || cqMap == MAP_FAILED || sqeMap == MAP_FAILED)
+        return false;
+
+    char* sq = (char*)sqMap;
+    sqHead = (unsigned*)(sq + params.sq_off.head);
+    sqTail = (unsigned*)(sq + params.sq_off.tail);
+    sqMask = *(unsigned*)(sq + params.sq_off.ring_mask);
+    sqArray = (unsigned*)(sq + params.sq_off.array);
+    sqes = (io_uring_sqe*)sqeMap;
+    char* cq = (char*)cqMap;
+    cqHead = (unsigned*)(cq + params.cq_off.head);
+    cqTail = (unsigned*)(cq + params.cq_off.tail);
+    cqMask = *(unsigned*)(cq + params.cq_off.ring_mask);
+    cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+    entries = params.sq_entries;
+    sqeTail = *sqTail;
+    return true;
+}
+
+FileReader::Ring::~Ring() {
+    if (sqeMap != MAP_FAILED) munmap(sqeMap, sqeMapLen);
+    if (cqMap != MAP_FAILED) munmap(cqMap, cqMapLen);
+    if (sqMap != MAP_FAILED) munmap(sqMap, sqMapLen);
+    if (fd >= 0) close(fd);
+}
+
+// Queue a cleared sqe, caller sets the op fields before the next submit.
+io_uring_sqe* FileReader::Ring::nextSqe(uint8_t opcode, uint64_t userData) {
+    assert(sqeTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) < entries);
+    unsigned idx = sqeTail++ & sqMask;
+    io_uring_sqe* sqe = &sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->user_data = userData;
+    sqArray[idx] = idx;
+    toSubmit++;
+    return sqe;
+}
+
+// Publish queued sqes and wait for waitCnt completions.
+void FileReader::Ring::submit(unsigned waitCnt) {
+    __atomic_store_n(sqTail, sqeTail, __ATOMIC_RELEASE);
+    unsigned flags = waitCnt != 0 ? IORING_ENTER_GETEVENTS : 0;
+    for (;;) {
+        int ret = (int)syscall(__NR_io_uring_enter, fd, toSubmit, waitCnt, flags, nullptr, 0);
+        if (ret >= 0) {
+            toSubmit -= std::min((unsigned)ret, toSubmit);
+            if (toSubmit == 0 || waitCnt != 0)
+                break;
+        } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            // Requests in flight own the file buffers, there is no safe way back.
+            cerr << strerror(errno) << ", io_uring_enter failed" << endl;
+            abort();
+        }
+    }
+}
+
+bool FileReader::Ring::popCqe(io_uring_cqe& cqe) {
+    unsigned head = *cqHead;
+    if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE))
+        return false;
+    cqe = cqes[head & cqMask];
+    __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+enum { OP_STAT, OP_OPEN, OP_READ, OP_CLOSE, OP_BITS = 2 };
+
+// State of one file of a batch.
+struct RingRequest {
+    struct statx stx;
+    int statRes = 0;
+    int openRes = -1;   // fd, or -errno
+    bool statDone = false;
+    bool openDone = false;
+    size_t size = 0;
+    size_t got = 0;
+};
+
+// -------------------------------------------------------------------------------------------------
+// Read one batch, statx and openat for all files go out together, a read follows as soon
+// as both completed for a file and a close as soon as its read completed.
+void FileReader::Ring::readBatch(XmlFile* const* files, size_t cnt,
+        const std::function<void(XmlFile&)>& done) {
+    vector<RingRequest> requests(cnt);
+    unsigned inFlight = 0;
+
+    auto queueRead = [&](size_t idx) {
+        RingRequest& request = requests[idx];
+        io_uring_sqe* sqe = nextSqe(IORING_OP_READ, (idx << OP_BITS) | OP_READ);
+        sqe->fd = request.openRes;
+        sqe->addr = (uint64_t)(files[idx]->buffer.data() + request.got);
+        sqe->len = (unsigned)std::min(request.size - request.got, (size_t)0x40000000);
+        sqe->off = request.got;
+        inFlight++;
+    };
+    auto queueClose = [&](int fd) {
+        io_uring_sqe* sqe = nextSqe(IORING_OP_CLOSE, OP_CLOSE);
+        sqe->fd = fd;
+        inFlight++;
+    };
+    auto finish = [&](size_t idx, const string& err) {
+        XmlFile& file = *files[idx];
+        file.log = err;
+        if (requests[idx].openRes >= 0)
+            queueClose(requests[idx].openRes);
+        done(file);
+    };
+    auto opened = [&](size_t idx) {
+        RingRequest& request = requests[idx];
+        XmlFile& file = *files[idx];
+        if (request.statRes < 0) {
+            finish(idx, "Error - empty or not a file: " + file.filePath + "\n");
+        } else if (request.openRes < 0) {
+            file.found = true;
+            finish(idx, string(strerror(-request.openRes)) + ", Unable to open: " + file.filePath + "\n");
+        } else {
+            file.found = true;
+            try {
+                request.size = request.stx.stx_size;
+                file.buffer.resize(request.size + 1);
+            } catch (exception ex) {
+                finish(idx, string(ex.what()) + ", Error in file: " + file.filePath + "\n");
+                return;
+            }
+            if (request.size == 0) {
+                file.buffer.push_back('\0');
+                file.read = true;
+                finish(idx, "");
+            } else {
+                queueRead(idx);
+            }
+        }
+    };
+
+    for (size_t idx = 0; idx < cnt; idx++) {
+        const char* path = files[idx]->filePath.c_str();
+        io_uring_sqe* sqe = nextSqe(IORING_OP_STATX, (idx << OP_BITS) | OP_STAT);
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t)path;
+        sqe->len = STATX_SIZE;
+        sqe->off = (uint64_t)&requests[idx].stx;
+        sqe = nextSqe(IORING_OP_OPENAT, (idx << OP_BITS) | OP_OPEN);
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t)path;
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        inFlight += 2;
+    }
+
+    io_uring_cqe cqe;
+    while (inFlight != 0) {
+        submit(1);
+        while (popCqe(cqe)) {
+            inFlight--;
+            size_t idx = (size_t)(cqe.user_data >> OP_BITS);
+            RingRequest& request = requests[idx];
+            switch (cqe.user_data & ((1 << OP_BITS) - 1)) {
+            case OP_STAT:
+                request.statRes = cqe.res;
+                request.statDone = true;
+                if (request.openDone)
+                    opened(idx);
+                break;
+            case OP_OPEN:
+                request.openRes = cqe.res;
+                request.openDone = true;
+                if (request.statDone)
+                    opened(idx);
+                break;
+            case OP_READ:
+                if (cqe.res > 0)
+                    request.got += cqe.res;
+                if (cqe.res > 0 && request.got < request.size) {
+                    queueRead(idx);     // short read, continue
+                } else {
+                    // Like the blocking read, a failed or early ending read keeps what was read.
+                    files[idx]->buffer.push_back('\0');
+                    files[idx]->read = true;
+                    finish(idx, "");
+                }
+                break;
+            }
+        }
+    }
+}
+
+#endif
+
+// -------------------------------------------------------------------------------------------------
+FileReader::FileReader(unsigned _batchSize) : batchSize(std::max(_batchSize, 1u)) {
+#ifdef HAVE_IO_URING
+    ring = new Ring();
+    if (! ring->setup(batchSize * 2)) {
+        delete ring;
+        ring = nullptr;
+    }
+#endif
+}
+
+FileReader::~FileReader() {
+#ifdef HAVE_IO_URING
+    delete ring;
+#endif
+}
+
+// -------------------------------------------------------------------------------------------------
+void FileReader::read(const vector<XmlFile*>& files, const std::function<void(XmlFile&)>& done) {
+#ifdef HAVE_IO_URING
+    if (ring != nullptr) {
+        for (size_t beg = 0; beg < files.size(); beg += batchSize) {
+            ring->readBatch(files.data() + beg, std::min(files.size() - beg, (size_t)batchSize), done);
+        }
+        return;
+    }
+#endif
+    for (XmlFile* file : files) {
+        readFile(*file);
+        done(*file);
+    }
+}
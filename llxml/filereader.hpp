@@ -0,0 +1,67 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: filereader.hpp   Author: Dennis Lang  Desc: Batched file reads
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// Resource trees hold many small files, reading them one stat/open/read/close at a time
+// is syscall and latency bound. On Linux a batch is submitted to io_uring: statx+openat
+// for all files, then reads, each file is handed on as soon as its read completes.
+// Without io_uring (other systems, old kernels, blocked by seccomp) files are read
+// one by one with blocking calls.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "xml.hpp"
+
+#include <functional>
+
+class FileReader {
+public:
+    explicit FileReader(unsigned batchSize);
+    ~FileReader();
+
+    // True if batches go through io_uring.
+    bool isAsync() const { return ring != nullptr; }
+    unsigned getBatchSize() const { return batchSize; }
+
+    // Read files, done is called for each file as soon as it is read or failed.
+    void read(const vector<XmlFile*>& files, const std::function<void(XmlFile&)>& done);
+
+    // Blocking read or archive entry extract, diagnostics are kept in file.log.
+    static void readFile(XmlFile& file);
+
+private:
+    struct Ring;
+    Ring* ring = nullptr;
+    unsigned batchSize;
+
+    FileReader(const FileReader&) = delete;
+    FileReader& operator=(const FileReader&) = delete;
+};
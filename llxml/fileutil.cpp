@@ -7,7 +7,13 @@
 //
 
 #include "fileutil.hpp"
-#include <sstream>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <fstream>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #ifdef WIN32
     const char SLASH_CHAR('\\');
@@ -16,9 +22,13 @@
     #if !defined(S_ISREG) && defined(S_IFMT) && defined(S_IFREG)
         #define S_ISREG(m) (((m)&S_IFMT) == S_IFREG)
     #endif
+    #include <direct.h>
+    #include <windows.h>
+    #define makeDir(path) _mkdir(path)
 #else
     const char SLASH_CHAR('/');
     #include <assert.h>
+    #define makeDir(path) mkdir(path, 0777)
 #endif
 
 
@@ -46,31 +56,147 @@ string& FileUtil::getDirs(string& outDirs, const string& inPath) {
 
 //-------------------------------------------------------------------------------------------------
 string& FileUtil::getParts(string& outParts, const char* customFmt, const string& inPath) {
-    stringstream sout;
-    string name;
-    string dirs;
-
-    const char* fmt = customFmt;
-    while (*fmt) {
-        char c = *fmt++;
-        if (c != '%') {
-            sout << c;
-        } else {
-            c = *fmt++;
-            switch (c) {
-            case 'n':   // name
-                sout << getName(name, inPath);
-                break;
-            case 'p':   // path
-                sout << getDirs(dirs, inPath);
-                break;
-            default:
-                sout << c;
-                break;
+    return PathFormat(customFmt).format(outParts, inPath);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Compared by hand, strcasecmp is not in the msvc runtime.
+bool FileUtil::hasExtension(const string& path, const char* ext) {
+    size_t len = strlen(ext);
+    if (path.length() <= len)
+        return false;
+    const char* tail = path.c_str() + path.length() - len;
+    for (size_t idx = 0; idx < len; idx++) {
+        if (tolower((unsigned char)tail[idx]) != tolower((unsigned char)ext[idx]))
+            return false;
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Temporary in the same directory, so the rename does not cross file systems.
+string FileUtil::tempPath(const string& path) {
+    return path + ".llxml-tmp";
+}
+
+//-------------------------------------------------------------------------------------------------
+bool FileUtil::renameOver(const string& fromPath, const string& toPath) {
+#ifdef WIN32
+    if (MoveFileExA(fromPath.c_str(), toPath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0)
+        return true;
+#else
+    if (rename(fromPath.c_str(), toPath.c_str()) == 0)
+        return true;
+#endif
+    remove(fromPath.c_str());
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool FileUtil::writeAtomic(const string& path, const char* data, size_t len) {
+    string tmpPath = tempPath(path);
+    ofstream outF(tmpPath, ios::binary);
+    if (! outF.is_open())
+        return false;
+    outF.write(data, len);
+    outF.close();
+    if (outF.fail()) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return renameOver(tmpPath, path);
+}
+
+//-------------------------------------------------------------------------------------------------
+FileUtil::PathFormat::PathFormat(const string& fmt) {
+    string text;
+    for (size_t pos = 0; pos < fmt.length(); pos++) {
+        char c = fmt[pos];
+        if (c == '%' && pos + 1 < fmt.length() && strchr("npfbedl", fmt[pos + 1]) != nullptr) {
+            if (! text.empty()) {
+                segments.push_back(Segment{ 0, text });
+                text.clear();
             }
+            segments.push_back(Segment{ fmt[++pos], "" });
+        } else {
+            if (c == '%' && pos + 1 < fmt.length())
+                c = fmt[++pos];     // %% and unknown tokens output the character
+            text += c;
         }
     }
+    if (! text.empty())
+        segments.push_back(Segment{ 0, text });
+}
 
-    outParts = sout.str();
-    return outParts;
+//-------------------------------------------------------------------------------------------------
+string& FileUtil::PathFormat::format(string& outPath, const string& inPath) const {
+    size_t nameBeg = inPath.rfind(SLASH_CHAR) + 1;   // 0 if no slash
+    size_t dirsEnd = (nameBeg == 0) ? 0 : nameBeg - 1;
+    size_t parentBeg = (dirsEnd == 0) ? 0 : inPath.rfind(SLASH_CHAR, dirsEnd - 1) + 1;
+    size_t extnPos = inPath.rfind('.');
+    if (extnPos == string::npos || extnPos < nameBeg)
+        extnPos = inPath.length();
+    size_t localePos = inPath.find('-', parentBeg);
+    if (localePos == string::npos || localePos >= dirsEnd)
+        localePos = dirsEnd;
+    else
+        localePos++;
+
+    outPath.clear();
+    for (const Segment& segment : segments) {
+        switch (segment.token) {
+        case 0:
+            outPath += segment.text;
+            break;
+        case 'n':   // name
+        case 'f':
+            outPath.append(inPath, nameBeg, string::npos);
+            break;
+        case 'p':   // path
+            outPath.append(inPath, 0, dirsEnd);
+            break;
+        case 'b':   // name without extension
+            outPath.append(inPath, nameBeg, extnPos - nameBeg);
+            break;
+        case 'e':   // extension
+            if (extnPos < inPath.length())
+                outPath.append(inPath, extnPos + 1, string::npos);
+            break;
+        case 'd':   // parent directory
+            outPath.append(inPath, parentBeg, dirsEnd - parentBeg);
+            break;
+        case 'l':   // locale qualifier of parent directory, values-fr-rCA is fr-rCA
+            outPath.append(inPath, localePos, dirsEnd - localePos);
+            break;
+        }
+    }
+    return outPath;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Return false if a parent directory could not be created.
+bool FileUtil::DirMaker::makeParents(const string& filePath) {
+    size_t dirEnd = filePath.rfind(SLASH_CHAR);
+    if (dirEnd == string::npos || dirEnd == 0)
+        return true;
+
+    string dir = filePath.substr(0, dirEnd);
+    lock_guard<mutex> lock(madeMutex);
+    if (made.count(dir) != 0)
+        return true;
+
+    // Create from the top, skipping parents already known.
+    size_t pos = 0;
+    while (pos != string::npos) {
+        pos = dir.find(SLASH_CHAR, pos + 1);
+        string part = dir.substr(0, pos);
+        if (made.count(part) == 0) {
+            struct stat info;
+            if (makeDir(part.c_str()) != 0 && errno != EEXIST
+                    && (stat(part.c_str(), &info) != 0 || (info.st_mode & S_IFDIR) == 0))
+                return false;
+            made.insert(part);
+        }
+    }
+    return true;
 }
@@ -9,7 +9,10 @@
 #ifndef fileutil_hpp
 #define fileutil_hpp
 
+#include <mutex>
 #include <string>
+#include <unordered_set>
+#include <vector>
 using namespace std;
 
 class FileUtil {
@@ -17,6 +20,41 @@ public:
     static string& getName(string& outName, const string& inPath);
     static string& getDirs(string& outDirs, const string& inPath);
     static string& getParts(string& outParts, const char* customFmt, const string& inPath);
+    // Path ends in ext, ascii case ignored, as ".json" for app.JSON.
+    static bool hasExtension(const string& path, const char* ext);
+
+    // Outputs are written to tempPath() and renamed over the target, so an interrupted
+    // run never leaves part of a file. renameOver removes the temporary if it fails.
+    static string tempPath(const string& path);
+    static bool renameOver(const string& fromPath, const string& toPath);
+    static bool writeAtomic(const string& path, const char* data, size_t len);
+
+    // Output path format compiled once, tokens for input path res/values-fr/strings.xml
+    //   %p res/values-fr   %d values-fr   %l fr
+    //   %n strings.xml     %b strings     %e xml     (%f same as %n)
+    class PathFormat {
+    public:
+        PathFormat(const string& fmt);
+        string& format(string& outPath, const string& inPath) const;
+
+    private:
+        struct Segment {
+            char token;         // 0 for literal text
+            string text;
+        };
+        vector<Segment> segments;
+    };
+
+    // Create missing parent directories of output files, remembers what already exists.
+    // Safe to share between output writer threads.
+    class DirMaker {
+    public:
+        bool makeParents(const string& filePath);
+
+    private:
+        unordered_set<string> made;
+        mutex madeMutex;
+    };
 };
 
 #endif /* fileutil_hpp */
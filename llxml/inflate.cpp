@@ -0,0 +1,381 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: inflate.cpp   Author: Dennis Lang  Desc: Deflate decoder
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#include "inflate.hpp"
+
+#include <string.h>
+#include <algorithm>
+
+static const unsigned FAST_BITS = 10;
+static const unsigned MAX_BITS = 15;
+static const unsigned MAX_LIT = 288;
+static const unsigned MAX_DIST = 30;
+static const size_t MAX_MATCH = 258;
+
+static const uint16_t LEN_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t LEN_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const uint8_t CLEN_ORDER[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// -------------------------------------------------------------------------------------------------
+// Canonical Huffman code. fast[] is indexed by the next FAST_BITS input bits and holds
+// (length << 9 | symbol), 0 if the code is longer.
+struct Huffman {
+    uint16_t fast[1 << FAST_BITS];
+    uint16_t count[MAX_BITS + 1];
+    uint16_t symbol[MAX_LIT];
+
+    bool build(const uint8_t* lengths, unsigned cnt);
+};
+
+bool Huffman::build(const uint8_t* lengths, unsigned cnt) {
+    uint16_t offset[MAX_BITS + 2];
+    memset(count, 0, sizeof(count));
+    memset(fast, 0, sizeof(fast));
+    for (unsigned sym = 0; sym < cnt; sym++)
+        count[lengths[sym]]++;
+    count[0] = 0;
+
+    int left = 1;
+    for (unsigned len = 1; len <= MAX_BITS; len++) {
+        left = (left << 1) - count[len];
+        if (left < 0)
+            return false;   // over subscribed, incomplete codes are allowed
+    }
+
+    offset[1] = 0;
+    for (unsigned len = 1; len <= MAX_BITS; len++)
+        offset[len + 1] = offset[len] + count[len];
+    for (unsigned sym = 0; sym < cnt; sym++) {
+        if (lengths[sym] != 0)
+            symbol[offset[lengths[sym]]++] = (uint16_t)sym;
+    }
+
+    // Deflate sends codes most significant bit first, the fast index is bit reversed.
+    unsigned code = 0;
+    unsigned index = 0;
+    for (unsigned len = 1; len <= FAST_BITS; len++) {
+        for (unsigned idx = 0; idx < count[len]; idx++, code++, index++) {
+            unsigned reversed = 0;
+            for (unsigned bit = 0; bit < len; bit++)
+                reversed |= ((code >> bit) & 1) << (len - 1 - bit);
+            for (unsigned fill = reversed; fill < (1u << FAST_BITS); fill += (1u << len))
+                fast[fill] = (uint16_t)((len << 9) | symbol[index]);
+        }
+        code <<= 1;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Least significant bit first reader with a 64 bit buffer.
+struct BitReader {
+    const uint8_t* ptr;
+    const uint8_t* end;
+    uint64_t bits = 0;
+    unsigned cnt = 0;
+
+    BitReader(const uint8_t* _ptr, const uint8_t* _end) : ptr(_ptr), end(_end) {}
+
+    void refill() {
+        while (cnt <= 56 && ptr < end) {
+            bits |= (uint64_t)*ptr++ << cnt;
+            cnt += 8;
+        }
+    }
+    bool need(unsigned num) {
+        if (cnt < num)
+            refill();
+        return cnt >= num;
+    }
+    unsigned get(unsigned num) {
+        unsigned val = (unsigned)(bits & ((1ull << num) - 1));
+        bits >>= num;
+        cnt -= num;
+        return val;
+    }
+    // Unused whole bytes go back to the input.
+    const uint8_t* bytePtr() const {
+        return ptr - cnt / 8;
+    }
+};
+
+// -------------------------------------------------------------------------------------------------
+// Next symbol, -1 if input ends or the code is invalid.
+static int decode(BitReader& in, const Huffman& huff) {
+    in.need(MAX_BITS);
+    unsigned entry = huff.fast[in.bits & ((1u << FAST_BITS) - 1)];
+    if (entry != 0) {
+        unsigned len = entry >> 9;
+        if (len > in.cnt)
+            return -1;
+        in.get(len);
+        return (int)(entry & 0x1FF);
+    }
+
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (unsigned len = 1; len <= MAX_BITS; len++) {
+        if (in.cnt == 0)
+            return -1;
+        code |= (int)in.get(1);
+        int count = huff.count[len];
+        if (code - count < first)
+            return huff.symbol[index + (code - first)];
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+// -------------------------------------------------------------------------------------------------
+static const Huffman* fixedCodes() {
+    static Huffman codes[2];
+    static bool ready = [] {
+        uint8_t lengths[MAX_LIT];
+        unsigned sym = 0;
+        for (; sym < 144; sym++) lengths[sym] = 8;
+        for (; sym < 256; sym++) lengths[sym] = 9;
+        for (; sym < 280; sym++) lengths[sym] = 7;
+        for (; sym < MAX_LIT; sym++) lengths[sym] = 8;
+        codes[0].build(lengths, MAX_LIT);
+        memset(lengths, 5, MAX_DIST);
+        codes[1].build(lengths, MAX_DIST);
+        return true;
+    }();
+    (void)ready;
+    return codes;
+}
+
+// -------------------------------------------------------------------------------------------------
+static bool dynamicCodes(BitReader& in, Huffman& lit, Huffman& dist) {
+    if (! in.need(14))
+        return false;
+    unsigned nLit = in.get(5) + 257;
+    unsigned nDist = in.get(5) + 1;
+    unsigned nClen = in.get(4) + 4;
+    if (nLit > 286 || nDist > MAX_DIST)
+        return false;
+
+    uint8_t lengths[MAX_LIT + MAX_DIST];
+    memset(lengths, 0, 19);
+    for (unsigned idx = 0; idx < nClen; idx++) {
+        if (! in.need(3))
+            return false;
+        lengths[CLEN_ORDER[idx]] = (uint8_t)in.get(3);
+    }
+    Huffman clen;
+    if (! clen.build(lengths, 19))
+        return false;
+
+    unsigned idx = 0;
+    while (idx < nLit + nDist) {
+        int sym = decode(in, clen);
+        if (sym < 0)
+            return false;
+        if (sym < 16) {
+            lengths[idx++] = (uint8_t)sym;
+            continue;
+        }
+        uint8_t len = 0;
+        unsigned repeat;
+        if (sym == 16) {
+            if (idx == 0 || ! in.need(2))
+                return false;
+            len = lengths[idx - 1];
+            repeat = 3 + in.get(2);
+        } else if (sym == 17) {
+            if (! in.need(3))
+                return false;
+            repeat = 3 + in.get(3);
+        } else {
+            if (! in.need(7))
+                return false;
+            repeat = 11 + in.get(7);
+        }
+        if (idx + repeat > nLit + nDist)
+            return false;
+        memset(lengths + idx, len, repeat);
+        idx += repeat;
+    }
+    if (lengths[256] == 0)
+        return false;   // no end of block code
+    return lit.build(lengths, nLit) && dist.build(lengths + nLit, nDist);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Decode a compressed block into out from outPos, stream starts at outBeg.
+static bool inflateBlock(BitReader& in, const Huffman& lit, const Huffman& dist,
+        std::vector<char>& out, size_t& outPos, size_t outBeg) {
+    for (;;) {
+        if (outPos + MAX_MATCH > out.size())
+            out.resize(std::max(out.capacity(), out.size() * 2 + MAX_MATCH));
+        int sym = decode(in, lit);
+        if (sym < 256) {
+            if (sym < 0)
+                return false;
+            out[outPos++] = (char)sym;
+            continue;
+        }
+        if (sym == 256)
+            return true;
+
+        sym -= 257;
+        if (sym >= 29 || ! in.need(LEN_EXTRA[sym]))
+            return false;
+        size_t len = LEN_BASE[sym] + in.get(LEN_EXTRA[sym]);
+        int dsym = decode(in, dist);
+        if (dsym < 0 || dsym >= 30 || ! in.need(DIST_EXTRA[dsym]))
+            return false;
+        size_t dst = DIST_BASE[dsym] + in.get(DIST_EXTRA[dsym]);
+        if (dst > outPos - outBeg)
+            return false;
+
+        char* to = &out[outPos];
+        const char* from = to - dst;
+        if (dst >= len) {
+            memcpy(to, from, len);
+        } else {
+            for (size_t idx = 0; idx < len; idx++)
+                to[idx] = from[idx];
+        }
+        outPos += len;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+bool Inflate::raw(const uint8_t*& inPtr, const uint8_t* end, std::vector<char>& out, std::string& error) {
+    BitReader in(inPtr, end);
+    size_t outBeg = out.size();
+    size_t outPos = outBeg;
+    bool last = false;
+    Huffman lit;
+    Huffman dist;
+
+    while (! last) {
+        if (! in.need(3)) {
+            error = "truncated";
+            break;
+        }
+        last = in.get(1) != 0;
+        unsigned type = in.get(2);
+        if (type == 0) {
+            // stored, LEN and NLEN after the byte boundary
+            in.get(in.cnt & 7);
+            if (! in.need(32)) {
+                error = "truncated";
+                break;
+            }
+            unsigned len = in.get(16);
+            if ((in.get(16) ^ 0xFFFF) != len) {
+                error = "bad stored block";
+                break;
+            }
+            if (outPos + len > out.size())
+                out.resize(outPos + len + MAX_MATCH);
+            while (len != 0 && in.cnt >= 8) {
+                out[outPos++] = (char)in.get(8);
+                len--;
+            }
+            if ((size_t)(in.end - in.ptr) < len) {
+                error = "truncated";
+                break;
+            }
+            memcpy(&out[outPos], in.ptr, len);
+            in.ptr += len;
+            outPos += len;
+        } else if (type == 1) {
+            const Huffman* fixed = fixedCodes();
+            if (! inflateBlock(in, fixed[0], fixed[1], out, outPos, outBeg)) {
+                error = "bad compressed data";
+                break;
+            }
+        } else if (type == 2) {
+            if (! dynamicCodes(in, lit, dist) || ! inflateBlock(in, lit, dist, out, outPos, outBeg)) {
+                error = "bad compressed data";
+                break;
+            }
+        } else {
+            error = "bad block type";
+            break;
+        }
+    }
+
+    out.resize(outPos);
+    inPtr = in.bytePtr();
+    return error.empty();
+}
+
+// -------------------------------------------------------------------------------------------------
+// Slicing by 8, table[k] advances a byte k further, so 8 bytes take 8 independent lookups.
+uint32_t Inflate::crc32(uint32_t crc, const void* data, size_t len) {
+    static uint32_t table[8][256];
+    static bool ready = [] {
+        for (uint32_t idx = 0; idx < 256; idx++) {
+            uint32_t val = idx;
+            for (int bit = 0; bit < 8; bit++)
+                val = (val & 1) ? (val >> 1) ^ 0xEDB88320u : val >> 1;
+            table[0][idx] = val;
+        }
+        for (uint32_t idx = 0; idx < 256; idx++) {
+            for (int slice = 1; slice < 8; slice++)
+                table[slice][idx] = table[0][table[slice - 1][idx] & 0xFF] ^ (table[slice - 1][idx] >> 8);
+        }
+        return true;
+    }();
+    (void)ready;
+
+    const uint8_t* ptr = (const uint8_t*)data;
+    crc = ~crc;
+    for (; len >= 8; len -= 8, ptr += 8) {
+        uint32_t lo = crc ^ (ptr[0] | (ptr[1] << 8) | (ptr[2] << 16) | ((uint32_t)ptr[3] << 24));
+        uint32_t hi = ptr[4] | (ptr[5] << 8) | (ptr[6] << 16) | ((uint32_t)ptr[7] << 24);
+        crc = table[7][lo & 0xFF] ^ table[6][(lo >> 8) & 0xFF] ^ table[5][(lo >> 16) & 0xFF] ^ table[4][lo >> 24]
+            ^ table[3][hi & 0xFF] ^ table[2][(hi >> 8) & 0xFF] ^ table[1][(hi >> 16) & 0xFF] ^ table[0][hi >> 24];
+    }
+    for (; len != 0; len--, ptr++)
+        crc = table[0][(crc ^ *ptr) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
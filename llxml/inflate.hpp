@@ -0,0 +1,53 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: inflate.hpp   Author: Dennis Lang  Desc: Deflate decoder
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// Raw deflate (RFC 1951) decoder for reading .zip and .gz inputs in memory, no zlib dependency.
+// Huffman codes up to FAST_BITS long decode with one table lookup, longer ones bit by bit.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Inflate {
+
+ // Decode one deflate stream at in, append it to out. On return in is just past the stream.
+ // Reserve out for the expected size, it grows to its capacity first.
+ bool raw(const uint8_t*& in, const uint8_t* end, std::vector<char>& out, std::string& error);
+
+ // CRC-32 (zip, gzip) of len bytes continuing from crc, start with 0.
+ uint32_t crc32(uint32_t crc, const void* data, size_t len);
+}
@@ -0,0 +1,327 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: journal.cpp   Author: Dennis Lang  Desc: Checkpoint journal to resume an interrupted merge
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#include "journal.hpp"
+#include "archive.hpp"
+#include "filereader.hpp"
+#include "fileutil.hpp"
+#include "inflate.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+static const char JOURNAL_MAGIC[] = "llxml-journal";
+static const uint64_t JOURNAL_VERSION = 2;
+
+// -------------------------------------------------------------------------------------------------
+void JournalIO::put(std::ostream& out, uint64_t value) {
+    out.write((const char*)&value, sizeof(value));
+}
+
+void JournalIO::put(std::ostream& out, const std::string& str) {
+    put(out, (uint64_t)str.length());
+    out.write(str.data(), str.length());
+}
+
+bool JournalIO::get(const char*& ptr, const char* end, uint64_t& value) {
+    if (end - ptr < (ptrdiff_t)sizeof(value))
+        return false;
+    memcpy(&value, ptr, sizeof(value));
+    ptr += sizeof(value);
+    return true;
+}
+
+bool JournalIO::get(const char*& ptr, const char* end, std::string& str) {
+    uint64_t len;
+    if (! get(ptr, end, len) || len > (uint64_t)(end - ptr))
+        return false;
+    str.assign(ptr, (size_t)len);
+    ptr += len;
+    return true;
+}
+
+using namespace JournalIO;
+
+// -------------------------------------------------------------------------------------------------
+static int64_t modifiedTime(const std::string& path) {
+    struct stat filestat;
+    return (stat(path.c_str(), &filestat) == 0) ? (int64_t)filestat.st_mtime : 0;
+}
+
+// -------------------------------------------------------------------------------------------------
+Journal::Journal(const std::string& _path, const std::string& _separator, unsigned _seconds) :
+    path(_path), separator(_separator), interval(_seconds) {
+    nextSave = std::chrono::steady_clock::now() + interval;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Readers append NULs after the content.
+static size_t contentLength(const std::vector<char>& buffer) {
+    size_t len = buffer.size();
+    while (len != 0 && buffer[len - 1] == '\0')
+        len--;
+    return len;
+}
+
+uint32_t Journal::digest(const std::vector<char>& buffer) {
+    return Inflate::crc32(0, buffer.data(), contentLength(buffer));
+}
+
+// -------------------------------------------------------------------------------------------------
+// Size and crc of a read file, mtime of what it was read from.
+bool Journal::stamp(JournalInput& input, const XmlFile& file) const {
+    input.separator = (file.filePath == separator);
+    input.path = file.filePath;
+    input.archive = (file.archive != nullptr) ? file.archive->getPath() : "";
+    input.entryIdx = file.entryIdx;
+    input.size = 0;
+    input.crc = 0;
+    input.mtime = 0;
+    if (input.separator)
+        return true;
+    input.mtime = modifiedTime(input.archive.empty() ? input.path : input.archive);
+    if (file.read) {
+        input.size = contentLength(file.buffer);
+        input.crc = file.crc;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Read the input again, archives are opened once for all their entries.
+bool Journal::unchanged(const JournalInput& input, std::map<std::string, std::shared_ptr<Archive>>& archives) const {
+    if (input.separator)
+        return true;
+    if (modifiedTime(input.archive.empty() ? input.path : input.archive) != input.mtime)
+        return false;
+
+    XmlFile file;
+    file.filePath = input.path;
+    if (! input.archive.empty()) {
+        std::shared_ptr<Archive>& archive = archives[input.archive];
+        if (archive == nullptr) {
+            archive = std::make_shared<Archive>();
+            archive->open(input.archive);
+        }
+        file.archive = archive;
+        file.entryIdx = (size_t)input.entryIdx;
+    }
+    FileReader::readFile(file);
+    if (file.read)
+        file.crc = digest(file.buffer);
+
+    JournalInput now;
+    stamp(now, file);
+    return now.size == input.size && now.crc == input.crc;
+}
+
+// -------------------------------------------------------------------------------------------------
+bool Journal::open(Diagnostics& diag, const std::string& args, XmlBuffer& xmlBuffer) {
+    argsCrc = Inflate::crc32(0, args.data(), args.length());
+
+    std::ifstream inF(path, std::ios::binary);
+    if (! inF.is_open())
+        return false;
+    inF.seekg(0, std::ios::end);
+    std::vector<char> data((size_t)inF.tellg());
+    inF.seekg(0, std::ios::beg);
+    inF.read(data.data(), data.size());
+    inF.close();
+
+    const char* ptr = data.data();
+    const char* end = ptr + data.size();
+    std::string magic;
+    uint64_t version, crc, count;
+    if (! get(ptr, end, magic) || magic != JOURNAL_MAGIC
+            || ! get(ptr, end, version) || version != JOURNAL_VERSION
+            || ! get(ptr, end, crc) || ! get(ptr, end, count)) {
+        diag.report(DIAG_INFO, path, "", "Journal not readable, starting over: " + path);
+        return false;
+    }
+    if (crc != argsCrc) {
+        diag.report(DIAG_INFO, path, "", "Journal is for other arguments, starting over: " + path);
+        return false;
+    }
+
+    std::vector<JournalInput> loaded;
+    bool ok = true;
+    for (uint64_t idx = 0; idx < count && ok; idx++) {
+        JournalInput input;
+        uint64_t sep = 0, mtime = 0, inCrc = 0;
+        ok = get(ptr, end, sep) && get(ptr, end, input.path) && get(ptr, end, input.archive)
+            && get(ptr, end, input.entryIdx) && get(ptr, end, input.size)
+            && get(ptr, end, mtime) && get(ptr, end, inCrc);
+        input.separator = (sep != 0);
+        input.mtime = (int64_t)mtime;
+        input.crc = (uint32_t)inCrc;
+        loaded.push_back(input);
+    }
+    if (! ok) {
+        diag.report(DIAG_INFO, path, "", "Journal not readable, starting over: " + path);
+        return false;
+    }
+
+    std::map<std::string, std::shared_ptr<Archive>> archives;
+    for (const JournalInput& input : loaded) {
+        if (! unchanged(input, archives)) {
+            diag.report(DIAG_INFO, input.path, "", "Journal input changed, starting over: " + input.path);
+            return false;
+        }
+    }
+    if (! xmlBuffer.loadState(ptr, end)) {
+        diag.report(DIAG_INFO, path, "", "Journal not readable, starting over: " + path);
+        return false;
+    }
+
+    // Outputs are appended after the state, a torn last one is dropped.
+    std::string outPath;
+    uint64_t size, outCrc;
+    while (get(ptr, end, outPath) && get(ptr, end, size) && get(ptr, end, outCrc)) {
+        outputs[outPath] = Output{ size, (uint32_t)outCrc };
+    }
+
+    inputs.swap(loaded);
+    resumeInputs = savedInputs = inputs.size();
+    diag.report(DIAG_INFO, path, "", "Resuming after " + std::to_string(inputs.size())
+        + " journaled inputs: " + path);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+bool Journal::skip(const std::string& filePath) {
+    if (failed)
+        return false;
+    if (nextInput >= resumeInputs || inputs[nextInput].path != filePath) {
+        failed = true;
+        return false;
+    }
+    nextInput++;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+void Journal::add(const XmlFile& file) {
+    JournalInput input;
+    stamp(input, file);
+    inputs.push_back(input);
+}
+
+// -------------------------------------------------------------------------------------------------
+bool Journal::due() const {
+    return inputs.size() != savedInputs && std::chrono::steady_clock::now() >= nextSave;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Rewrite the whole journal, a crash leaves the previous checkpoint.
+void Journal::checkpoint(Diagnostics& diag, const XmlBuffer& xmlBuffer) {
+    if (inputs.size() == savedInputs)
+        return;
+
+    std::lock_guard<std::mutex> lock(outputMutex);
+    if (outputLog.is_open())
+        outputLog.close();
+
+    std::string tmpPath = FileUtil::tempPath(path);
+    std::ofstream outF(tmpPath, std::ios::binary);
+    if (outF.is_open()) {
+        put(outF, JOURNAL_MAGIC);
+        put(outF, JOURNAL_VERSION);
+        put(outF, argsCrc);
+        put(outF, (uint64_t)inputs.size());
+        for (const JournalInput& input : inputs) {
+            put(outF, (uint64_t)input.separator);
+            put(outF, input.path);
+            put(outF, input.archive);
+            put(outF, input.entryIdx);
+            put(outF, input.size);
+            put(outF, (uint64_t)input.mtime);
+            put(outF, (uint64_t)input.crc);
+        }
+        xmlBuffer.saveState(outF);
+        for (const auto& output : outputs) {
+            put(outF, output.first);
+            put(outF, output.second.size);
+            put(outF, (uint64_t)output.second.crc);
+        }
+        outF.close();
+    }
+    if (outF.fail() || ! FileUtil::renameOver(tmpPath, path)) {
+        remove(tmpPath.c_str());
+        diag.report(DIAG_ERROR, path, "", "Failed writing journal: " + path);
+    }
+    savedInputs = inputs.size();
+    nextSave = std::chrono::steady_clock::now() + interval;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Same size and crc as recorded, and still on disk.
+bool Journal::written(const std::string& outPath, const std::string& content) const {
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        auto found = outputs.find(outPath);
+        if (found == outputs.end() || found->second.size != content.length()
+                || found->second.crc != Inflate::crc32(0, content.data(), content.length()))
+            return false;
+    }
+    std::ifstream inF(outPath, std::ios::binary);
+    std::vector<char> data(content.length() + 1);
+    inF.read(data.data(), data.size());
+    return (size_t)inF.gcount() == content.length()
+        && memcmp(data.data(), content.data(), content.length()) == 0;
+}
+
+// -------------------------------------------------------------------------------------------------
+void Journal::wrote(const std::string& outPath, const std::string& content) {
+    Output output{ content.length(), Inflate::crc32(0, content.data(), content.length()) };
+    std::lock_guard<std::mutex> lock(outputMutex);
+    outputs[outPath] = output;
+    if (savedInputs == 0)
+        return;             // no checkpoint to append to
+    if (! outputLog.is_open())
+        outputLog.open(path, std::ios::binary | std::ios::app);
+    put(outputLog, outPath);
+    put(outputLog, output.size);
+    put(outputLog, (uint64_t)output.crc);
+    outputLog.flush();
+}
+
+// -------------------------------------------------------------------------------------------------
+void Journal::finish() {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    if (outputLog.is_open())
+        outputLog.close();
+    remove(path.c_str());
+}
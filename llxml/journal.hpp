@@ -0,0 +1,128 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: journal.hpp   Author: Dennis Lang  Desc: Checkpoint journal to resume an interrupted merge
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// With -journal the merged master state and the inputs merged so far are written to the
+// journal every few seconds, through a temporary renamed over it. A rerun with the same
+// arguments loads the state and skips the traversal prefix the journal holds, after checking
+// size, mtime and content crc32 of each input. Outputs written are appended, and skipped when
+// a rerun would write the same bytes that are already there.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "diagnostics.hpp"
+#include "xml.hpp"
+
+// Binary journal fields, native byte order, a journal stays on the machine that wrote it.
+namespace JournalIO {
+ void put(std::ostream& out, uint64_t value);
+ void put(std::ostream& out, const std::string& str);
+ bool get(const char*& ptr, const char* end, uint64_t& value);
+ bool get(const char*& ptr, const char* end, std::string& str);
+}
+
+// Input merged before the last checkpoint, in traversal order.
+struct JournalInput {
+    bool separator = false;
+    std::string path;
+    std::string archive;    // archive file of an entry, else empty
+    uint64_t entryIdx = 0;
+    uint64_t size = 0;      // content bytes, 0 if not read
+    int64_t mtime = 0;      // of the file, or of its archive
+    uint32_t crc = 0;       // content crc32
+};
+
+class Journal {
+public:
+    Journal(const std::string& _path, const std::string& _separator, unsigned _seconds);
+
+    // Crc32 of the content of a read file, without the NULs the reader appends.
+    static uint32_t digest(const std::vector<char>& buffer);
+
+    // Load the state of a journal written with the same arguments, if its inputs are unchanged.
+    bool open(Diagnostics& diag, const std::string& args, XmlBuffer& xmlBuffer);
+
+    // Journaled inputs are being skipped, or the traversal did not match them.
+    bool resuming() const { return failed || nextInput < resumeInputs; }
+    bool mismatch() const { return failed || nextInput != resumeInputs; }
+    // Skip next input of the traversal, false if it is not the journaled one.
+    bool skip(const std::string& filePath);
+
+    // Record a merged input or separator.
+    void add(const XmlFile& file);
+    // Time for a checkpoint, and something new to save.
+    bool due() const;
+    void checkpoint(Diagnostics& diag, const XmlBuffer& xmlBuffer);
+
+    // Output with these bytes already written, and recording it. Safe from writer threads.
+    bool written(const std::string& outPath, const std::string& content) const;
+    void wrote(const std::string& outPath, const std::string& content);
+
+    // All outputs are written, nothing to resume.
+    void finish();
+
+    const std::string& getPath() const { return path; }
+
+private:
+    std::string path;
+    std::string separator;
+    std::chrono::seconds interval;
+    std::chrono::steady_clock::time_point nextSave;
+    uint64_t argsCrc = 0;
+    std::vector<JournalInput> inputs;
+    size_t resumeInputs = 0;
+    size_t nextInput = 0;
+    size_t savedInputs = 0;
+    bool failed = false;
+
+    struct Output {
+        uint64_t size;
+        uint32_t crc;
+    };
+    std::map<std::string, Output> outputs;
+    std::ofstream outputLog;
+    mutable std::mutex outputMutex;
+
+    bool stamp(JournalInput& input, const XmlFile& file) const;
+    bool unchanged(const JournalInput& input, std::map<std::string, std::shared_ptr<Archive>>& archives) const;
+};
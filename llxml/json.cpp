@@ -0,0 +1,347 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: json.cpp   Author: Dennis Lang  Desc: Json resource strings
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#include "json.hpp"
+#include "xml.hpp"
+#include "textkernel.hpp"
+#include "fileutil.hpp"
+
+#include <string.h>
+
+static const char KEY_SEPARATOR = '.';
+
+// -------------------------------------------------------------------------------------------------
+bool Json::isJsonPath(const std::string& path) {
+    return FileUtil::hasExtension(path, ".json");
+}
+
+// -------------------------------------------------------------------------------------------------
+void Json::appendUtf8(std::string& text, unsigned code) {
+    if (code < 0x80) {
+        text += (char)code;
+    } else if (code < 0x800) {
+        text += (char)(0xC0 | (code >> 6));
+        text += (char)(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        text += (char)(0xE0 | (code >> 12));
+        text += (char)(0x80 | ((code >> 6) & 0x3F));
+        text += (char)(0x80 | (code & 0x3F));
+    } else {
+        text += (char)(0xF0 | (code >> 18));
+        text += (char)(0x80 | ((code >> 12) & 0x3F));
+        text += (char)(0x80 | ((code >> 6) & 0x3F));
+        text += (char)(0x80 | (code & 0x3F));
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+static bool getHex4(const char* ptr, const char* end, unsigned& code) {
+    if (end - ptr < 4)
+        return false;
+    code = 0;
+    for (int idx = 0; idx < 4; idx++) {
+        char c = ptr[idx];
+        unsigned digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+        else return false;
+        code = code * 16 + digit;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+void Json::unescape(const char* beg, const char* end, std::string& text) {
+    text.clear();
+    if (end - beg >= 2 && *beg == '"' && end[-1] == '"') {
+        beg++;
+        end--;
+    }
+    while (beg < end) {
+        size_t run = TextKernel::findQuote(beg, end - beg);
+        text.append(beg, run);
+        beg += run;
+        if (beg + 1 >= end) {
+            text.append(beg, end);
+            break;
+        }
+        char esc = beg[1];
+        beg += 2;
+        switch (esc) {
+        case 'b': text += '\b'; break;
+        case 'f': text += '\f'; break;
+        case 'n': text += '\n'; break;
+        case 'r': text += '\r'; break;
+        case 't': text += '\t'; break;
+        case 'u': {
+            unsigned code;
+            if (! getHex4(beg, end, code)) {
+                text += "\\u";
+                break;
+            }
+            beg += 4;
+            unsigned low;
+            if (code >= 0xD800 && code < 0xDC00 && end - beg >= 6 && beg[0] == '\\' && beg[1] == 'u'
+                    && getHex4(beg + 2, end, low) && low >= 0xDC00 && low < 0xE000) {
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                beg += 6;
+            }
+            Json::appendUtf8(text, code);
+            break;
+        }
+        default:    // \" \\ \/
+            text += esc;
+            break;
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+void Json::escape(const std::string& text, std::string& literal) {
+    static const char HEX[] = "0123456789abcdef";
+    literal.clear();
+    literal.reserve(text.length() + 2);
+    literal += '"';
+    for (char c : text) {
+        switch (c) {
+        case '"':  literal += "\\\""; break;
+        case '\\': literal += "\\\\"; break;
+        case '\b': literal += "\\b"; break;
+        case '\f': literal += "\\f"; break;
+        case '\n': literal += "\\n"; break;
+        case '\r': literal += "\\r"; break;
+        case '\t': literal += "\\t"; break;
+        default:
+            if ((unsigned char)c < 0x20) {
+                literal += "\\u00";
+                literal += HEX[(c >> 4) & 0xF];
+                literal += HEX[c & 0xF];
+            } else {
+                literal += c;
+            }
+            break;
+        }
+    }
+    literal += '"';
+}
+
+// -------------------------------------------------------------------------------------------------
+static const char* skipJsonWhite(const char* ptr, const char* endPtr) {
+    while (ptr < endPtr && (*ptr == ' ' || *ptr == '\n' || *ptr == '\r' || *ptr == '\t'))
+        ptr++;
+    return ptr;
+}
+
+// -------------------------------------------------------------------------------------------------
+// End of the string literal starting at ptr ('"'), just past its closing quote, nullptr
+// if it is not closed. String text is skipped with the vector findQuote kernel.
+static const char* findStringEnd(const char* ptr, const char* endPtr) {
+    ptr++;
+    while (ptr < endPtr) {
+        ptr += TextKernel::findQuote(ptr, endPtr - ptr);
+        if (ptr == endPtr)
+            break;
+        if (*ptr == '"')
+            return ptr + 1;
+        ptr += 2;   // escaped character
+    }
+    return nullptr;
+}
+
+// -------------------------------------------------------------------------------------------------
+size_t Json::valueLength(const char* beg, const char* end) {
+    const char* ptr = beg;
+    if (ptr < end && *ptr == '"') {
+        ptr = findStringEnd(ptr, end);
+        return (ptr != nullptr) ? ptr - beg : end - beg;
+    }
+    while (ptr < end && strchr(",}] \t\r\n", *ptr) == nullptr)
+        ptr++;
+    return ptr - beg;
+}
+
+// Open object or array while scanning.
+struct JsonLevel {
+    bool array;
+    size_t keyLen;          // key of the object or array itself
+    unsigned index;
+};
+
+// -------------------------------------------------------------------------------------------------
+// Scan a json resource in a single pass into the same items as scan(), one data item for
+// each string value, holding it and the text up to the next value as an xml statement holds
+// its trailing white space. Values outside a selected namespace
+// (json has none, so only if -namespace has no include) or rejected by keyFilter are meta.
+bool XmlBuffer::scanJson(size_t& pos, size_t end, XmlItems& items, bool lazy) const {
+    const char* begPtr = data();
+    const char* ptr = begPtr + pos;
+    const char* endPtr = begPtr + end;
+    while (endPtr > ptr && endPtr[-1] == '\0')
+        endPtr--;           // reader terminates buffers
+    const char* itemPtr = ptr;      // start of the item not yet added
+    bool nsSelected = (nsFilter == nullptr || nsFilter->selected(""));
+    vector<JsonLevel> levels;
+    string key;
+    string name;
+
+    size_t firstItem = items.size();
+    // Add item from itemPtr, the previous one ends there.
+    auto addItem = [&](bool isMeta) {
+        if (items.size() > firstItem) {
+            items.back().end = itemPtr;
+            if (! lazy)
+                getValue(items.back());
+        }
+        items.push_back(XmlItem());
+        XmlItem& item = items.back();
+        item.beg = itemPtr;
+        item.lazy = true;
+        item.json = true;
+        item.isMeta = isMeta;
+        if (! isMeta)
+            item.key = key;
+    };
+    auto fail = [&](const char* at) {
+        if (items.size() > firstItem) {
+            items.back().end = at;
+            if (! lazy)
+                getValue(items.back());
+        }
+        pos = at - begPtr;
+        items.push_back(XmlItem());
+        LineCursor lines;
+        items.back().error = "Error - Line: " + to_string(lineAt(pos, lines)) + " Unknown: "
+            + string(at, std::min(at + 10, endPtr)) + ", In:";
+        items.back().abort = true;
+        return false;
+    };
+    // Member name and ':' of an object, sets key to the member path.
+    auto getMember = [&](const JsonLevel& level) {
+        ptr = skipJsonWhite(ptr, endPtr);
+        const char* nameEnd = (ptr < endPtr && *ptr == '"') ? findStringEnd(ptr, endPtr) : nullptr;
+        if (nameEnd == nullptr)
+            return false;
+        Json::unescape(ptr, nameEnd, name);
+        ptr = skipJsonWhite(nameEnd, endPtr);
+        if (ptr == endPtr || *ptr != ':')
+            return false;
+        ptr++;
+        key.resize(level.keyLen);
+        if (! key.empty())
+            key += KEY_SEPARATOR;
+        key += name;
+        return true;
+    };
+
+    ptr = skipJsonWhite(ptr, endPtr);
+    bool haveValue = (ptr != endPtr);   // empty file is no resources
+    while (haveValue) {
+        // Value
+        ptr = skipJsonWhite(ptr, endPtr);
+        if (ptr == endPtr)
+            return fail(ptr);
+        char chr = *ptr;
+        if (chr == '{' || chr == '[') {
+            levels.push_back(JsonLevel{ chr == '[', key.length(), 0 });
+            ptr = skipJsonWhite(ptr + 1, endPtr);
+            if (ptr != endPtr && *ptr == (chr == '[' ? ']' : '}')) {
+                levels.pop_back();
+                ptr++;
+            } else {
+                if (chr == '[')
+                    key += "[0]";
+                else if (! getMember(levels.back()))
+                    return fail(ptr);
+                continue;
+            }
+        } else if (chr == '"') {
+            const char* litEnd = findStringEnd(ptr, endPtr);
+            if (litEnd == nullptr)
+                return fail(ptr);
+            if (! levels.empty()) {
+                if (items.size() == firstItem && ptr != itemPtr)
+                    addItem(true);      // text ahead of the first value
+                itemPtr = ptr;
+                bool selected = nsSelected && (keyFilter == nullptr || keyFilter->selected(key));
+                addItem(! selected);
+            }
+            ptr = litEnd;
+        } else {
+            // number, true, false or null, kept in meta
+            const char* scalarBeg = ptr;
+            while (ptr < endPtr && strchr(",}] \t\r\n", *ptr) == nullptr)
+                ptr++;
+            if (ptr == scalarBeg)
+                return fail(ptr);
+        }
+
+        // After value, ',' or close of the open levels
+        for (;;) {
+            ptr = skipJsonWhite(ptr, endPtr);
+            if (levels.empty()) {
+                haveValue = false;
+                break;
+            }
+            if (ptr == endPtr)
+                return fail(ptr);
+            JsonLevel& level = levels.back();
+            if (*ptr == ',') {
+                ptr++;
+                if (level.array) {
+                    key.resize(level.keyLen);
+                    key += "[" + to_string(++level.index) + "]";
+                } else if (! getMember(level)) {
+                    return fail(ptr);
+                }
+                break;
+            }
+            if (*ptr != (level.array ? ']' : '}'))
+                return fail(ptr);
+            key.resize(level.keyLen);
+            levels.pop_back();
+            ptr++;
+        }
+    }
+
+    if (ptr != endPtr)
+        return fail(ptr);
+    if (items.size() == firstItem)
+        addItem(true);
+    items.back().end = endPtr;
+    if (! lazy)
+        getValue(items.back());
+    pos = end;
+    return true;
+}
@@ -0,0 +1,62 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: json.hpp   Author: Dennis Lang  Desc: Json resource strings
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// Json resources, as i18next translation files, are scanned into the same FileData model as
+// xml. Nested objects join their keys with '.', array entries are keyed name[index] as the
+// <item>s of a <string-array>. Each string value is one data row, its quoted literal followed by
+// the text up to the next value ("Radar",\n  "word3": ), text ahead of the first value is meta.
+// Updates replace the literal and keep the text of the master, a master value cleared before
+// its children are merged is null.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#pragma once
+
+#include <string>
+
+namespace Json {
+
+ // Json resources are selected by file extension, .json
+ bool isJsonPath(const std::string& path);
+
+ // Text of a quoted json string literal, escapes decoded and \uXXXX as UTF-8.
+ void unescape(const char* beg, const char* end, std::string& text);
+
+ // Append code point as UTF-8.
+ void appendUtf8(std::string& text, unsigned code);
+
+ // Length of the value a data statement starts with, a string literal or null.
+ size_t valueLength(const char* beg, const char* end);
+
+ // Quoted json string literal of text.
+ void escape(const std::string& text, std::string& literal);
+}
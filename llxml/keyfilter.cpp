@@ -0,0 +1,124 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: keyfilter.cpp   Author: Dennis Lang  Desc: Key include/exclude glob patterns
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "keyfilter.hpp"
+
+// -------------------------------------------------------------------------------------------------
+KeyTrie::KeyTrie() : nodes(1) {
+}
+
+// -------------------------------------------------------------------------------------------------
+void KeyTrie::add(const std::string& glob) {
+    size_t wildPos = glob.find_first_of("*?");
+    size_t prefixLen = (wildPos == std::string::npos) ? glob.length() : wildPos;
+
+    unsigned nodeIdx = 0;
+    for (size_t idx = 0; idx < prefixLen; idx++) {
+        unsigned nextIdx = 0;
+        for (const auto& next : nodes[nodeIdx].next) {
+            if (next.first == glob[idx]) {
+                nextIdx = next.second;
+                break;
+            }
+        }
+        if (nextIdx == 0) {
+            nextIdx = (unsigned)nodes.size();
+            nodes[nodeIdx].next.push_back(std::make_pair(glob[idx], nextIdx));
+            nodes.push_back(Node());
+        }
+        nodeIdx = nextIdx;
+    }
+
+    Node& node = nodes[nodeIdx];
+    if (wildPos == std::string::npos)
+        node.exact = true;
+    else if (glob.compare(wildPos, std::string::npos, "*") == 0)
+        node.anySuffix = true;
+    else
+        node.globs.push_back(glob.substr(wildPos));
+    patterns++;
+}
+
+// -------------------------------------------------------------------------------------------------
+bool KeyTrie::matches(const std::string& key) const {
+    const char* keyPtr = key.data();
+    const char* keyEnd = keyPtr + key.length();
+    const Node* node = &nodes[0];
+
+    for (const char* ptr = keyPtr; ; ptr++) {
+        if (node->anySuffix)
+            return true;
+        for (const std::string& glob : node->globs) {
+            if (globMatch(glob.c_str(), ptr, keyEnd))
+                return true;
+        }
+        if (ptr == keyEnd)
+            return node->exact;
+
+        const Node* nextNode = nullptr;
+        for (const auto& next : node->next) {
+            if (next.first == *ptr) {
+                nextNode = &nodes[next.second];
+                break;
+            }
+        }
+        if (nextNode == nullptr)
+            return false;
+        node = nextNode;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Match str against glob, on a mismatch only the last * is retried one character further.
+bool KeyTrie::globMatch(const char* glob, const char* str, const char* strEnd) {
+    const char* starGlob = nullptr;
+    const char* starStr = nullptr;
+
+    while (str < strEnd) {
+        if (*glob == '*') {
+            starGlob = ++glob;
+            starStr = str;
+        } else if (*glob != '\0' && (*glob == '?' || *glob == *str)) {
+            glob++;
+            str++;
+        } else if (starGlob != nullptr) {
+            glob = starGlob;
+            str = ++starStr;
+        } else {
+            return false;
+        }
+    }
+    while (*glob == '*')
+        glob++;
+    return *glob == '\0';
+}
@@ -0,0 +1,75 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: keyfilter.hpp   Author: Dennis Lang  Desc: Key include/exclude glob patterns
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// Key patterns are checked for every entry of 100k key files, so they are not regex.
+// The literal prefix of each glob (up to its first * or ?) is a path in a trie, a key
+// walks the trie once and only the patterns hanging off the nodes it passes are matched
+// against the rest of the key. A prefix pattern such as settings_* needs no glob match.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+class KeyTrie {
+public:
+    KeyTrie();
+
+    // Add glob, * matches any run of characters, ? any one character.
+    void add(const std::string& glob);
+    bool empty() const { return patterns == 0; }
+    bool matches(const std::string& key) const;
+
+private:
+    struct Node {
+        std::vector<std::pair<char, unsigned>> next;
+        std::vector<std::string> globs;     // rest of the patterns, starting with a wildcard
+        bool exact = false;                 // a pattern ends here
+        bool anySuffix = false;             // a pattern ends here with *
+    };
+    std::vector<Node> nodes;
+    size_t patterns = 0;
+
+    static bool globMatch(const char* glob, const char* str, const char* strEnd);
+};
+
+// Keys selected with -keyInclude and -keyExclude.
+struct KeyFilter {
+    KeyTrie include;
+    KeyTrie exclude;
+
+    bool empty() const { return include.empty() && exclude.empty(); }
+    bool selected(const std::string& key) const {
+        return (include.empty() || include.matches(key)) && ! exclude.matches(key);
+    }
+};
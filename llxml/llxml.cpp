@@ -65,7 +65,15 @@
 #include "directory.hpp"
 #include "split.hpp"
 #include "xml.hpp"
+#include "pipeline.hpp"
+#include "filereader.hpp"
 #include "fileutil.hpp"
+#include "diagnostics.hpp"
+#include "json.hpp"
+#include "archive.hpp"
+#include "journal.hpp"
+#include "shard.hpp"
+#include "perfcounters.hpp"
 
 #include <assert.h>
 #include <ctype.h>
@@ -77,7 +85,9 @@
 #include <iostream>
 #include <map>
 #include <regex>
+#include <set>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 using namespace std;
@@ -93,18 +103,36 @@ static PatternList includePathPatList;
 static PatternList excludePathPatList;
 static StringList fileDirList;
 static XmlBuffer xmlBuffer;
+static Diagnostics diag(cerr);
+static XmlNamespaceFilter nsFilter;
+static KeyFilter keyFilter;
+static Journal* journal = nullptr;
+static ShardSpec shard;
+static size_t inputCount = 0;       // inputs seen by the traversal, diag.order with -shard
 
 static bool showInfo = false;
 static bool verbose = false;
 static bool master = true;
+static bool nulPathList = false;    // -0, stdin path list is NUL separated
+static bool sortPathList = false;   // -locality, read path list groups in directory, inode order
+static bool mergeShards = false;    // -mergeShards, arguments are shard reports
+static bool countPerf = false;      // -perfcounters
+static PerfCounters perfCounters;
 
 static string outPath;
+static string csvPath;
+static string journalPath;
+static unsigned journalSeconds = 30;    // between checkpoints
 static string separator = ",";
 
 static uint optionErrCnt = 0;
 static uint patternErrCnt = 0;
 static uint parseErrCnt = 0;
 
+static size_t queueDepth[] = { 64, 0, 0 };  // read, parse, merge, 0 is 4 per thread
+static const size_t CHILD_BATCH = 16;       // children per parse thread merged by key shards
+static const unsigned READ_BATCH = 32;      // files per io_uring submission
+
 #ifdef WIN32
 
     #define strncasecmp _strnicmp
@@ -139,61 +167,355 @@ static bool FileMatches(const lstring& inName, const PatternList& patternList, b
     return false;
 }
 
+// -------------------------------------------------------------------------------------------------
+// Report rows of a master file.
+static void ShowMasterInfo(const lstring& filepath) {
+    const FileData& fileData = xmlBuffer.filesData.at(filepath);
+    diag.flush();
+    std::cout << "Parsed: " << filepath
+        << " rows=" << fileData.rows.size()
+        << " data=" << fileData.data.size()
+        << " meta=" << fileData.meta.size();
+    if (! fileData.namespaces.empty())
+        std::cout << " namespaces=" << fileData.namespaces.size();
+    std::cout << std::endl;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Report running update and extra totals after a child file.
+static void ShowChildInfo(const lstring& filepath, uint updates, uint extras) {
+    diag.flush();
+    std::cout << "Parsed: " << filepath
+        << " updates=" << updates
+        << " extras=" << extras
+        << std::endl;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Scan file read by FileReader.
+static void ScanFile(XmlFile& file) {
+    if (file.read) {
+        try {
+            file.buffer.parseThreads = xmlBuffer.parseThreads;
+            file.buffer.nsFilter = xmlBuffer.nsFilter;
+            file.buffer.keyFilter = xmlBuffer.keyFilter;
+            file.buffer.perf = xmlBuffer.perf;
+            file.buffer.intern = xmlBuffer.intern;
+            file.buffer.json = Json::isJsonPath(file.filePath);
+            if (journal != nullptr)
+                file.crc = Journal::digest(file.buffer);
+            file.buffer.scanFile(file.items, file.master);
+        } catch (exception ex) {
+            file.log += string(ex.what()) + ", Error in file: " + file.filePath + "\n";
+            file.read = false;
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Report file diagnostics and apply its items, return true if parsed.
+static bool MergeFile(XmlFile& file) {
+    diag.order = file.input;
+    if (journal != nullptr)
+        journal->add(file);
+    Split lines(file.log, "\n");
+    for (const lstring& line : lines) {
+        diag.report(DIAG_ERROR, file.filePath, "", line);
+    }
+    if (! file.found)
+        return false;
+
+    bool parseOk = false;
+    if (file.read) {
+        parseOk = xmlBuffer.applyFile(diag, file);
+        if (! parseOk) {
+            diag.report(DIAG_ERROR, file.filePath, "", "Error - failed to parse: " + file.filePath);
+            parseErrCnt++;
+        }
+    }
+
+    if (verbose) diag.report(DIAG_INFO, file.filePath, "", (parseOk ? "Parsed: " : " Failed: ") + file.filePath);
+    return parseOk;
+}
+
 // -------------------------------------------------------------------------------------------------
 // Open, read and parse file.
-static bool ParseFile(const lstring& filepath, const lstring& filename) {
+static bool ParseFile(const lstring& filepath, const lstring& filename,
+        const shared_ptr<const Archive>& archive, size_t entryIdx, size_t input) {
 
     if (filepath == separator) {
         master = false;
         xmlBuffer.clearData();
+        if (journal != nullptr) {
+            XmlFile file;
+            file.filePath = filepath;
+            journal->add(file);
+        }
         return false;
     }
 
-    ifstream in;
-    // ofstream out;
-    struct stat filestat;
-    bool parseOk = false;
+    XmlFile file;
+    file.filePath = filepath;
+    file.master = master;
+    file.archive = archive;
+    file.entryIdx = entryIdx;
+    file.input = input;
+    FileReader::readFile(file);
+    ScanFile(file);
+    return MergeFile(file);
+}
 
-    try {
-        if (stat(filepath, &filestat) != 0) {
-            cerr << "Error - empty or not a file: " << filepath << endl;
-            return false;
+// -------------------------------------------------------------------------------------------------
+// Save merged state and inputs to the journal, call when every merged input has been added.
+static void Checkpoint() {
+    if (journal != nullptr && journal->due())
+        journal->checkpoint(diag, xmlBuffer);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Read -> parse -> merge pipeline used with -threads. The main thread feeds it file names
+// while walking directories, so disk reads, parsing and merging overlap. Each stage has
+// a bounded input queue, the merge stage owns filesData and merges in command line order.
+class FilePipeline {
+public:
+    FilePipeline(size_t readDepth, size_t parseDepth, size_t mergeDepth, unsigned threads);
+    void submit(const lstring& filepath, const shared_ptr<const Archive>& archive, size_t entryIdx, size_t input);
+    void finish();
+
+private:
+    BoundedQueue<XmlFile> readQueue;
+    BoundedQueue<XmlFile> parseQueue;
+    BoundedQueue<XmlFile> mergeQueue;
+    FileReader fileReader;
+    thread reader;
+    vector<thread> parsers;
+    thread merger;
+    size_t nextSeq = 0;
+    vector<XmlFile> children;    // scanned children waiting for a sharded update
+
+    void readStage();
+    void parseStage();
+    void mergeStage();
+    void merge(XmlFile& file);
+    void mergeChildren();
+};
+
+static FilePipeline* filePipeline = nullptr;
+
+FilePipeline::FilePipeline(size_t readDepth, size_t parseDepth, size_t mergeDepth, unsigned threads) :
+    readQueue("read", readDepth),
+    parseQueue("parse", parseDepth),
+    mergeQueue("merge", mergeDepth),
+    fileReader(READ_BATCH) {
+    reader = thread(&FilePipeline::readStage, this);
+    for (unsigned idx = 0; idx < threads; idx++) {
+        parsers.push_back(thread(&FilePipeline::parseStage, this));
+    }
+    merger = thread(&FilePipeline::mergeStage, this);
+}
+
+// Queue file (or separator) in command line order, blocks while the read queue is full.
+void FilePipeline::submit(const lstring& filepath, const shared_ptr<const Archive>& archive, size_t entryIdx, size_t input) {
+    XmlFile file;
+    file.seq = nextSeq++;
+    file.input = input;
+    file.filePath = filepath;
+    file.master = master;
+    file.archive = archive;
+    file.entryIdx = entryIdx;
+    if (filepath == separator) {
+        master = false;
+    }
+    readQueue.push(std::move(file));
+}
+
+// Drain all stages, report queue occupancy if verbose.
+void FilePipeline::finish() {
+    readQueue.close();
+    reader.join();
+    for (thread& parser : parsers) {
+        parser.join();
+    }
+    mergeQueue.close();
+    merger.join();
+
+    if (verbose && diag.json) {
+        // {"category":"pipeline","name":"read","depth":8,...}, not text inside the json lines
+        vector<pair<string, uint64_t>> values;
+        values.push_back(make_pair("io_uring", (uint64_t)fileReader.isAsync()));
+        values.push_back(make_pair("batch", (uint64_t)fileReader.getBatchSize()));
+        diag.stats("reader", values, "pipeline");
+        diag.stats(readQueue.getName(), readQueue.counts(), "pipeline");
+        diag.stats(parseQueue.getName(), parseQueue.counts(), "pipeline");
+        diag.stats(mergeQueue.getName(), mergeQueue.counts(), "pipeline");
+    } else if (verbose) {
+        diag.flush();
+        cerr << "Reader: " << (fileReader.isAsync() ? "io_uring" : "blocking")
+            << " batch=" << fileReader.getBatchSize() << endl;
+        readQueue.report(cerr);
+        parseQueue.report(cerr);
+        mergeQueue.report(cerr);
+    }
+}
+
+// Read files in batches of what is queued, each goes on to parse as soon as it is read.
+void FilePipeline::readStage() {
+    vector<XmlFile> batch;
+    vector<XmlFile*> toRead;
+    XmlFile file;
+    while (readQueue.pop(file)) {
+        batch.clear();
+        toRead.clear();
+        do {
+            batch.push_back(std::move(file));
+        } while (batch.size() < fileReader.getBatchSize() && readQueue.tryPop(file));
+
+        for (XmlFile& item : batch) {
+            if (item.filePath == separator || item.archive != nullptr)
+                parseQueue.push(std::move(item));       // archive entries inflate on parse threads
+            else
+                toRead.push_back(&item);
         }
+        fileReader.read(toRead, [this](XmlFile& done) { parseQueue.push(std::move(done)); });
+    }
+    parseQueue.close();
+}
+
+void FilePipeline::parseStage() {
+    XmlFile file;
+    while (parseQueue.pop(file)) {
+        if (file.archive != nullptr)
+            FileReader::readFile(file);
+        ScanFile(file);
+        mergeQueue.push(std::move(file));
+    }
+}
 
-        in.open(filepath);
-        if (in.good()) {
-            xmlBuffer.resize(filestat.st_size + 1);
-            streamsize inCnt = in.read(xmlBuffer.data(), xmlBuffer.size()).gcount();
-            assert(inCnt < xmlBuffer.size());
-            in.close();
-            xmlBuffer.push_back('\0');
+// Parse workers finish out of order, hold files until their turn.
+void FilePipeline::mergeStage() {
+    map<size_t, XmlFile> pending;
+    size_t mergeSeq = 0;
+    XmlFile file;
+    while (mergeQueue.pop(file)) {
+        size_t seq = file.seq;
+        pending.emplace(seq, std::move(file));
+        for (auto iter = pending.find(mergeSeq); iter != pending.end(); iter = pending.find(++mergeSeq)) {
+            merge(iter->second);
+            pending.erase(iter);
+        }
+    }
+    mergeChildren();
+}
+
+void FilePipeline::merge(XmlFile& file) {
+    if (file.filePath == separator) {
+        mergeChildren();
+        xmlBuffer.clearData();
+        if (journal != nullptr)
+            journal->add(file);
+        Checkpoint();
+    } else if (file.master) {
+        if (MergeFile(file) && showInfo) {
+            ShowMasterInfo(file.filePath);
+        }
+        Checkpoint();
+    } else {
+        children.push_back(std::move(file));
+        if (children.size() >= CHILD_BATCH * parsers.size())
+            mergeChildren();
+    }
+}
 
-            parseOk = xmlBuffer.parse(std::cerr, filepath, master);
+// Update the masters by key shards and report each child, same output as merging them one by one.
+void FilePipeline::mergeChildren() {
+    uint updates = xmlBuffer.getUpdates();
+    uint extras = xmlBuffer.getExtras();
+    xmlBuffer.updateChildren(children);
+
+    for (XmlFile& child : children) {
+        bool parseOk = MergeFile(child);
+        updates += child.updates;
+        extras += child.extras;
+        if (parseOk && showInfo) {
+            ShowChildInfo(child.filePath, updates, extras);
+        }
+    }
+    children.clear();
+    Checkpoint();
+}
 
-            if (! parseOk) {
-                cerr << "Error - failed to parse: " << filepath << endl;
-                parseErrCnt++;
+// -------------------------------------------------------------------------------------------------
+// Parse file, or queue it on the pipeline.
+static size_t AddFile(const lstring& fullname, const lstring& name,
+        const shared_ptr<const Archive>& archive = nullptr, size_t entryIdx = 0) {
+    size_t fileCount = 0;
+    size_t input = ++inputCount;
+    if (journal != nullptr && journal->resuming()) {
+        // Merged before the journal checkpoint, only the separator changes what follows.
+        if (journal->skip(fullname) && fullname == separator)
+            master = false;
+    } else if (filePipeline != nullptr) {
+        filePipeline->submit(fullname, archive, entryIdx, input);
+        fileCount++;
+    } else {
+        if (ParseFile(fullname, name, archive, entryIdx, input)) {
+            fileCount++;
+            if (showInfo) {
+                if (master) {
+                    ShowMasterInfo(fullname);
+                } else {
+                    ShowChildInfo(fullname, xmlBuffer.getUpdates(), xmlBuffer.getExtras());
+                }
             }
-        } else {
-            cerr << strerror(errno) << ", Unable to open: " << filepath << endl;
         }
-    } catch (exception ex) {
-        cerr << ex.what() << ", Error in file: " << filepath << endl;
+        Checkpoint();
     }
+    return fileCount;
+}
 
-    if (verbose) cerr << (parseOk ? "Parsed: " : " Failed: ") << filepath << std::endl;
-    return parseOk;
+// -------------------------------------------------------------------------------------------------
+// Add entries of a .zip or .gz file which match the include and exclude patterns.
+// A bad archive is added as is, so its error is reported in order.
+static size_t InspectArchive(const lstring& fullname) {
+    shared_ptr<Archive> archive = make_shared<Archive>();
+    if (! archive->open(fullname)) {
+        return AddFile(fullname, fullname, archive, 0);
+    }
+
+    size_t fileCount = 0;
+    string name, dirs;
+    for (size_t idx = 0; idx < archive->size(); idx++) {
+        lstring entryPath = archive->entryPath(idx);
+        FileUtil::getName(name, entryPath);
+        FileUtil::getDirs(dirs, entryPath);
+        if (! name.empty()
+            && ! FileMatches(name, excludeFilePatList, false)
+            && FileMatches(name, includeFilePatList, true)
+            && ! FileMatches(dirs, excludePathPatList, false)
+            && FileMatches(dirs, includePathPatList, true)  ) {
+            fileCount += AddFile(entryPath, name, archive, idx);
+        }
+    }
+    return fileCount;
 }
 
 // -------------------------------------------------------------------------------------------------
-// Locate matching files which are not in exclude list.
+// Locate matching files which are not in exclude list. Include patterns of an archive
+// apply to its entries.
 static size_t InspectFile(const lstring& fullname) {
     size_t fileCount = 0;
     string name, dirs;
     FileUtil::getName(name, fullname);
     FileUtil::getDirs(dirs, fullname);
 
-    if (! name.empty()
+    if (fullname == separator) {
+        AddFile(fullname, name);            // not subject to include patterns
+    } else if (! name.empty() && Archive::isArchive(name)) {
+        if (! FileMatches(name, excludeFilePatList, false)
+            && ! FileMatches(dirs, excludePathPatList, false)) {
+            fileCount += InspectArchive(fullname);
+        }
+    } else if (! name.empty()
         && ! FileMatches(name, excludeFilePatList, false)
         && FileMatches(name, includeFilePatList, true)
         && ! FileMatches(dirs, excludePathPatList, false)
@@ -201,23 +523,24 @@ static size_t InspectFile(const lstring& fullname) {
 
         // if (verbose) cerr << fullname << std::endl;
 
-        if (ParseFile(fullname, name)) {
-            fileCount++;
-            if (showInfo) {
-                if (master) {
-                    const FileData& fileData = xmlBuffer.filesData.at(fullname);
-                    std::cout << "Parsed: " << fullname
-                        << " rows=" << fileData.rows.size()
-                        << " data=" << fileData.data.size()
-                        << " meta=" << fileData.meta.size()
-                        << std::endl;
-                } else {
-                    std::cout << "Parsed: " << fullname
-                        << " updates=" <<  xmlBuffer.getUpdates()
-                        << " extras=" << xmlBuffer.getExtras()
-                        << std::endl;
-                }
-            }
+        fileCount += AddFile(fullname, name);
+    }
+
+    return fileCount;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Recurse over directory entries, subdirectories are opened relative to their parent.
+static size_t InspectDirectory(Directory_files& directory) {
+    lstring fullname;
+    size_t fileCount = 0;
+
+    while (directory.more()) {
+        if (directory.is_directory()) {
+            Directory_files subDirectory(directory, directory.name());
+            fileCount += InspectDirectory(subDirectory);
+        } else if (directory.fullName(fullname).length() > 0) {
+            fileCount += InspectFile(fullname);
         }
     }
 
@@ -228,7 +551,6 @@ static size_t InspectFile(const lstring& fullname) {
 // Recurse over directories, locate files.
 static size_t InspectFiles(const lstring& dirname) {
     Directory_files directory(dirname);
-    lstring fullname;
 
     size_t fileCount = 0;
 
@@ -244,16 +566,117 @@ static size_t InspectFiles(const lstring& dirname) {
         // std::cerr << ex.what() << std::endl;
     }
 
-    while (directory.more()) {
-        directory.fullName(fullname);
-        if (directory.is_directory()) {
-            fileCount += InspectFiles(fullname);
-        } else if (fullname.length() > 0) {
-            fileCount += InspectFile(fullname);
+    return fileCount + InspectDirectory(directory);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Regular file of a path list group, kept for locality ordering.
+struct PathEntry {
+    lstring path;
+    lstring dir;
+    ino_t ino;
+
+    bool operator<(const PathEntry& other) const {
+        int cmp = dir.compare(other.dir);
+        return cmp != 0 ? cmp < 0 : ino < other.ino;
+    }
+};
+
+// Master or child group of a path list, files are deduped by device and inode.
+struct PathGroup {
+    set<pair<dev_t, ino_t>> seen;
+    vector<PathEntry> files;
+};
+
+// -------------------------------------------------------------------------------------------------
+// Inspect sorted files of group.
+static void FlushPathGroup(PathGroup& group) {
+    std::stable_sort(group.files.begin(), group.files.end());
+    for (const PathEntry& entry : group.files) {
+        InspectFile(entry.path);
+    }
+    group.files.clear();
+    group.seen.clear();
+}
+
+// -------------------------------------------------------------------------------------------------
+// Regular files go straight to InspectFile, anything else (directory, pattern) is walked.
+static void InspectPath(const lstring& path, PathGroup& group) {
+    struct stat filestat;
+    if (path.empty())
+        return;
+
+    if (path == separator) {
+        FlushPathGroup(group);
+        InspectFile(path);
+    } else if (stat(path, &filestat) == 0 && S_ISREG(filestat.st_mode)) {
+        if (group.seen.insert(make_pair(filestat.st_dev, filestat.st_ino)).second) {
+            if (sortPathList) {
+                PathEntry entry;
+                entry.path = path;
+                FileUtil::getDirs(entry.dir, path);
+                entry.ino = filestat.st_ino;
+                group.files.push_back(entry);
+            } else {
+                InspectFile(path);
+            }
+        }
+    } else {
+        InspectFiles(path);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Read path list from stdin, one path per line or NUL separated (find -print0).
+static void InspectPathList() {
+    const char delim = nulPathList ? '\0' : '\n';
+    vector<char> buffer(64 * 1024);
+    lstring path;
+    PathGroup group;
+    size_t inCnt;
+
+    while ((inCnt = fread(buffer.data(), 1, buffer.size(), stdin)) > 0) {
+        const char* ptr = buffer.data();
+        const char* endPtr = ptr + inCnt;
+        const char* delimPtr;
+        while ((delimPtr = (const char*)memchr(ptr, delim, endPtr - ptr)) != nullptr) {
+            path.append(ptr, delimPtr);
+            InspectPath(path, group);
+            path.clear();
+            ptr = delimPtr + 1;
         }
+        path.append(ptr, endPtr);
     }
+    InspectPath(path, group);
+    FlushPathGroup(group);
+}
 
-    return fileCount;
+// -------------------------------------------------------------------------------------------------
+// Totals of this shard, summed by -mergeShards.
+static void ShowShardStats() {
+    uint64_t masters = 0;
+    for (const auto& file : xmlBuffer.filesData) {
+        if (! file.second.foreign)
+            masters++;
+    }
+    vector<pair<string, uint64_t>> values;
+    values.push_back(make_pair("masters", masters));
+    values.push_back(make_pair("updates", (uint64_t)xmlBuffer.getUpdates()));
+    values.push_back(make_pair("extras", (uint64_t)xmlBuffer.getExtras()));
+    diag.flush();
+    diag.stats(shard.name(), values);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Combine -diag=json reports of -shard runs, given as the file arguments.
+static void MergeShardReports() {
+    ShardReport report;
+    string error;
+    for (const lstring& path : fileDirList) {
+        if (! report.read(path, error))
+            diag.report(DIAG_ERROR, path, "", "Error - " + error);
+    }
+    report.report(diag);
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -304,11 +727,33 @@ int main(int argc, char* argv[]) {
                       "   -pathExclude=<pathPattern>\n"
                       "   -showInput\n"
                       "   -verbose\n"
-                      "   -outFmt=%p-AA/%f \n"
+                      "   -outFmt=%p-AA/%n     ; Output path, missing directories are created\n"
+                      "        %p=path %n=name %b=base name %e=extension %d=parent dir %l=locale of parent dir\n"
+                      "   -csv=<file.csv>      ; Key by file matrix of merged values, .tsv for tabs, - for stdout\n"
+                      "   -threads=<count>     ; Parse large files and child files in parallel\n"
+                      "   -queue=<read>,<parse>,<merge> ; Pipeline queue depths with -threads\n"
+                      "   -0                   ; Path list from stdin (-) is NUL separated, as find -print0\n"
+                      "   -locality            ; Read path list files by directory and inode\n"
+                      "   -maxWarnings=<count> ; Output at most count warnings of each kind, summarize the rest\n"
+                      "   -diag=json           ; Diagnostics as JSON lines on stderr\n"
+                      "   -namespace=<name>    ; Only merge BEGIN/END NAMESPACE sections matching name\n"
+                      "   -namespace=!<name>   ; Skip sections matching name, both can be repeated\n"
+                      "   -keyInclude=<keyPattern>  ; Only merge keys matching, as settings_*\n"
+                      "   -keyExclude=<keyPattern>\n"
+                      "   -journal=<file>[,<seconds>] ; Checkpoint every 30 seconds, a rerun resumes from it\n"
+                      "   -shard=<i>/<N>       ; Update and write only the masters of shard i, 1 to N\n"
+                      "   -mergeShards         ; Combine -diag=json reports of the shards given as files\n"
+                      "   -perfcounters        ; Cycles, instructions and cache misses per MB of each phase (Linux)\n"
+                      "   -intern              ; Equal master values share one copy, less memory for repeated values\n"
                       "\n"
                       " Example:\n"
                       "   llxml -inc=\\*xml -excludePath=\\*value-\\* \n"
                       "   llxml main1.xml dir2/main2.xml , child1.xml child2.xml \n"
+                      "   llxml en.json , fr.xml              ; json and xml update each other\n"
+                      "   llxml main.xml , drop.zip fr.xml.gz ; archive entries are inflated in memory\n"
+                      "   (find main -name \\*.xml; echo ,; find lang -name \\*.xml) | llxml -locality - \n"
+                      "   llxml -shard=1/2 -diag=json -out=%n m , c 2> s1.json   ; and 2/2 on another machine\n"
+                      "   llxml -mergeShards s1.json s2.json \n"
                       "\n"
                       " Example input xml:\n"
                       "    <?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
@@ -318,6 +763,14 @@ int main(int argc, char* argv[]) {
                       "        <!-- comment -->\n"
                       "        <string name=\"word1\">Your Drive</string>\n"
                       "        <string name=\"word2\">Radar</string>\n"
+                      "        <plurals name=\"files\">              ; items merge as files[one], files[other]\n"
+                      "            <item quantity=\"one\">%d file</item>\n"
+                      "            <item quantity=\"other\">%d files</item>\n"
+                      "        </plurals>\n"
+                      "        <string-array name=\"days\">          ; items merge as days[0], days[1]\n"
+                      "            <item>Mon</item>\n"
+                      "            <item>Tue</item>\n"
+                      "        </string-array>\n"
                       "    </resources>\n"
                       "\n"
                       "   Output:\n"
@@ -326,7 +779,7 @@ int main(int argc, char* argv[]) {
         bool doParseCmds = true;
         string endCmds = "--";
         for (int argn = 1; argn < argc; argn++) {
-            if (*argv[argn] == '-' && doParseCmds) {
+            if (*argv[argn] == '-' && argv[argn][1] != '\0' && doParseCmds) {
                 lstring argStr(argv[argn]);
                 Split cmdValue(argStr, "=", 2);
                 if (cmdValue.size() == 2) {
@@ -334,6 +787,21 @@ int main(int argc, char* argv[]) {
                     lstring value = cmdValue[1];
 
                     switch (cmd[(unsigned)1]) {
+                    case 'c':   // csv=out.csv
+                        if (ValidOption("csv", cmd + 1)) {
+                            csvPath = value;
+                        }
+                        break;
+                    case 'd':   // diag=json
+                        if (ValidOption("diag", cmd + 1)) {
+                            if (value == "json" || value == "text") {
+                                diag.json = (value == "json");
+                            } else {
+                                std::cerr << "Unknown diag format " << value << ", expect json or text" << std::endl;
+                                optionErrCnt++;
+                            }
+                        }
+                        break;
                     case 'f':  // fileExclude=<pat>
                         if (ValidOption("fileExclude", cmd + 1, false)) {
                             ReplaceAll(value, "*", ".*");
@@ -352,11 +820,60 @@ int main(int argc, char* argv[]) {
                             includePathPatList.push_back(getRegEx(value));
                         }
                         break;
+                    case 'j':   // journal=run.journal,30
+                        if (ValidOption("journal", cmd + 1)) {
+                            Split parts(value, ",");
+                            journalPath = parts.size() > 0 ? parts[0] : "";
+                            if (parts.size() > 1)
+                                journalSeconds = std::max(1, atoi(parts[1]));
+                        }
+                        break;
+                    case 'k':   // keyExclude=<glob>
+                        if (ValidOption("keyExclude", cmd + 1, false)) {
+                            keyFilter.exclude.add(value);
+                        } else if (ValidOption("keyInclude", cmd + 1)) {
+                            keyFilter.include.add(value);
+                        }
+                        break;
+                    case 'm':   // maxWarnings=100
+                        if (ValidOption("maxWarnings", cmd + 1)) {
+                            diag.maxWarnings = std::max(0, atoi(value));
+                        }
+                        break;
+                    case 'n':   // namespace=<pat> or namespace=!<pat>
+                        if (ValidOption("namespace", cmd + 1)) {
+                            bool exclude = (value[(unsigned)0] == '!');
+                            lstring pattern = exclude ? value.substr(1) : value;
+                            ReplaceAll(pattern, "*", ".*");
+                            (exclude ? nsFilter.exclude : nsFilter.include).push_back(getRegEx(pattern));
+                        }
+                        break;
                     case 'o':   // main=outMain.xml
-                        if (ValidOption("outpath", cmd + 1)) {
+                        if (ValidOption("outFmt", cmd + 1, false) || ValidOption("outpath", cmd + 1)) {
                             outPath = value;
                         }
                         break;
+                    case 'q':   // queue=64,16,16
+                        if (ValidOption("queue", cmd + 1)) {
+                            Split depths(value, ",");
+                            for (size_t idx = 0; idx < depths.size() && idx < 3; idx++) {
+                                queueDepth[idx] = std::max(1, atoi(depths[idx]));
+                            }
+                        }
+                        break;
+                    case 's':   // shard=2/4
+                        if (ValidOption("shard", cmd + 1)) {
+                            if (! shard.parse(value)) {
+                                std::cerr << "Invalid shard " << value << ", expect i/N with 1 <= i <= N" << std::endl;
+                                optionErrCnt++;
+                            }
+                        }
+                        break;
+                    case 't':   // threads=4
+                        if (ValidOption("threads", cmd + 1)) {
+                            xmlBuffer.parseThreads = std::max(1, atoi(value));
+                        }
+                        break;
 
                     default:
                         std::cerr << "Unknown command " << cmd << std::endl;
@@ -371,6 +888,27 @@ int main(int argc, char* argv[]) {
                     case 'v':  // -v=true or -v=anyThing
                         verbose = true;
                         continue;
+                    case '0':  // -0 NUL separated path list
+                        nulPathList = true;
+                        continue;
+                    case 'l':  // -locality
+                        sortPathList = true;
+                        continue;
+                    case 'm':  // -mergeShards
+                        if (ValidOption("mergeShards", argStr + 1)) {
+                            mergeShards = true;
+                        }
+                        continue;
+                    case 'p':  // -perfcounters
+                        if (ValidOption("perfcounters", argStr + 1)) {
+                            countPerf = true;
+                        }
+                        continue;
+                    case 'i':  // -intern
+                        if (ValidOption("intern", argStr + 1)) {
+                            xmlBuffer.intern = true;
+                        }
+                        continue;
                     }
 
                     if (endCmds == argv[argn]) {
@@ -386,13 +924,51 @@ int main(int argc, char* argv[]) {
             }
         }
 
+        if (! nsFilter.empty()) {
+            xmlBuffer.nsFilter = &nsFilter;
+        }
+        if (! keyFilter.empty()) {
+            xmlBuffer.keyFilter = &keyFilter;
+        }
+        if (shard.count > 1) {
+            xmlBuffer.shard = &shard;
+            diag.ordered = true;
+        }
+        if (countPerf) {
+            string error;
+            if (perfCounters.open(error))
+                xmlBuffer.perf = &perfCounters;
+            if (! error.empty())
+                diag.report(DIAG_INFO, "", "", "Perf counters not available: " + error);
+        }
+        if (mergeShards) {
+            if (optionErrCnt == 0)
+                MergeShardReports();
+            diag.summary(verbose);
+            return 0;
+        }
         if (patternErrCnt == 0 && optionErrCnt == 0 &&
                     fileDirList.size() != 0) {
-            if (fileDirList.size() == 1 && fileDirList[0] == "-") {
-                string filePath;
-                while (std::getline(std::cin, filePath)) {
-                    InspectFiles(filePath);
+            if (! journalPath.empty()) {
+                string args;    // what the journal holds results for, without -journal
+                for (int argn = 1; argn < argc; argn++) {
+                    if (strncasecmp(argv[argn], "-j", 2) != 0) {
+                        args += argv[argn];
+                        args += '\0';
+                    }
+                }
+                journal = new Journal(journalPath, separator, journalSeconds);
+                journal->open(diag, args, xmlBuffer);
+            }
+            if (xmlBuffer.parseThreads > 1) {
+                unsigned threads = xmlBuffer.parseThreads;
+                for (size_t& depth : queueDepth) {
+                    if (depth == 0) depth = 4 * threads;
                 }
+                filePipeline = new FilePipeline(queueDepth[0], queueDepth[1], queueDepth[2], threads);
+            }
+            if (fileDirList.size() == 1 && fileDirList[0] == "-") {
+                InspectPathList();
             } else {
                 for (auto const& filePath : fileDirList) {
                     InspectFiles(filePath);
@@ -400,9 +976,35 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        xmlBuffer.writeFilesTo(outPath, verbose);
-
-        std::cerr << std::endl;
+        if (filePipeline != nullptr) {
+            filePipeline->finish();
+            delete filePipeline;
+        }
+        diag.order = Diagnostics::TAIL_ORDER;
+        if (journal != nullptr && journal->mismatch()) {
+            diag.report(DIAG_ERROR, journalPath, "", "Inputs differ from journal, remove it to start over: " + journalPath);
+        } else {
+            if (journal != nullptr)
+                journal->checkpoint(diag, xmlBuffer);
+            size_t errors = diag.count(DIAG_ERROR);
+            xmlBuffer.writeFilesTo(diag, outPath, verbose, journal);
+            diag.order = Diagnostics::TAIL_ORDER;
+            xmlBuffer.writeCsv(diag, csvPath);
+            if (journal != nullptr && diag.count(DIAG_ERROR) == errors)
+                journal->finish();      // kept to retry failed outputs
+        }
+        delete journal;
+        if (shard.count > 1)
+            ShowShardStats();
+        if (xmlBuffer.perf != nullptr) {
+            diag.flush();
+            perfCounters.report(diag);
+        }
+        if (verbose)
+            xmlBuffer.reportKeys(diag);
+        if (! diag.json)
+            std::cerr << std::endl;
+        diag.summary(verbose);
     }
 
     return 0;
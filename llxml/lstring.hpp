@@ -33,6 +33,7 @@
 #pragma once
 
 
+#include <cstring>
 #include <string>
 #include <algorithm>
 #include <regex>        // ReplaceAll using regex
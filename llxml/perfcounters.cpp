@@ -0,0 +1,203 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: perfcounters.cpp   Author: Dennis Lang  Desc: Hardware counters of the merge phases
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#include "perfcounters.hpp"
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char* PHASE_NAMES[PerfCounters::PHASES] = { "parse", "update", "write" };
+static const char* COUNTER_NAMES[PerfCounters::COUNTERS] = {
+    "taskNsec", "cycles", "instructions", "branchMisses", "l1dMisses", "llcMisses"
+};
+
+#ifdef __linux__
+
+static const uint64_t L1D_READ_MISS = PERF_COUNT_HW_CACHE_L1D
+    | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+static const uint64_t LLC_READ_MISS = PERF_COUNT_HW_CACHE_LL
+    | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+static const struct { uint32_t type; uint64_t config; } EVENTS[PerfCounters::COUNTERS] = {
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_HW_CACHE, L1D_READ_MISS },
+    { PERF_TYPE_HW_CACHE, LLC_READ_MISS },
+};
+
+// Count the calling thread in user space, which perf_event_paranoid 2 still permits.
+static int openEvent(size_t counter) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = EVENTS[counter].type;
+    attr.config = EVENTS[counter].config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// Events of a thread, opened on its first scope and closed when it ends.
+struct ThreadEvents {
+    int fds[PerfCounters::COUNTERS];
+    bool opened = false;
+    unsigned depth = 0;     // open scopes
+
+    ~ThreadEvents() {
+        if (opened) {
+            for (int fd : fds) {
+                if (fd >= 0)
+                    close(fd);
+            }
+        }
+    }
+};
+
+#else
+
+static int openEvent(size_t) {
+    errno = ENOSYS;
+    return -1;
+}
+
+struct ThreadEvents {
+    unsigned depth = 0;
+};
+
+#endif
+
+static thread_local ThreadEvents threadEvents;
+
+// -------------------------------------------------------------------------------------------------
+bool PerfCounters::open(std::string& error) {
+    bool any = false;
+    error.clear();
+    for (size_t counter = 0; counter < COUNTERS; counter++) {
+        int fd = openEvent(counter);
+        available[counter] = fd >= 0;
+        if (fd >= 0) {
+#ifdef __linux__
+            close(fd);
+#endif
+            any = true;
+        } else {
+            int err = errno;
+            if (! error.empty())
+                error += ", ";
+            error += std::string(COUNTER_NAMES[counter]) + " (" + strerror(err) + ")";
+            if (err == EACCES || err == EPERM)
+                error += " see /proc/sys/kernel/perf_event_paranoid";
+        }
+    }
+    return any;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Current thread's counts, scaled up when the kernel multiplexed a counter.
+void PerfCounters::read(uint64_t values[COUNTERS]) const {
+#ifdef __linux__
+    ThreadEvents& events = threadEvents;
+    if (! events.opened) {
+        for (size_t counter = 0; counter < COUNTERS; counter++)
+            events.fds[counter] = available[counter] ? openEvent(counter) : -1;
+        events.opened = true;
+    }
+    for (size_t counter = 0; counter < COUNTERS; counter++) {
+        uint64_t data[3] = {};    // value, time enabled, time running
+        values[counter] = 0;
+        if (events.fds[counter] >= 0 && ::read(events.fds[counter], data, sizeof(data)) == sizeof(data)) {
+            values[counter] = (data[2] != 0 && data[2] < data[1])
+                ? (uint64_t)((double)data[0] * data[1] / data[2]) : data[0];
+        }
+    }
+#else
+    for (size_t counter = 0; counter < COUNTERS; counter++)
+        values[counter] = 0;
+#endif
+}
+
+// -------------------------------------------------------------------------------------------------
+void PerfCounters::add(Phase phase, const uint64_t start[COUNTERS], const uint64_t end[COUNTERS], uint64_t inputBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t counter = 0; counter < COUNTERS; counter++) {
+        if (end[counter] > start[counter])
+            totals[phase][counter] += end[counter] - start[counter];
+    }
+    bytes += inputBytes;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Without input the totals are reported as counted.
+void PerfCounters::report(Diagnostics& diag) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    double perMB = bytes != 0 ? 1024.0 * 1024.0 / bytes : 1.0;
+    std::string suffix = bytes != 0 ? "/MB" : "";
+    for (size_t phase = 0; phase < PHASES; phase++) {
+        std::vector<std::pair<std::string, uint64_t>> values;
+        values.push_back(std::make_pair("bytes", bytes));
+        for (size_t counter = 0; counter < COUNTERS; counter++) {
+            if (available[counter])
+                values.push_back(std::make_pair(COUNTER_NAMES[counter] + suffix, (uint64_t)(totals[phase][counter] * perMB)));
+        }
+        diag.stats(PHASE_NAMES[phase], values, "perf");
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+PerfCounters::Scope::Scope(PerfCounters* perf, Phase phase, uint64_t inputBytes) :
+        perf(perf), phase(phase), inputBytes(inputBytes) {
+    if (perf != nullptr && threadEvents.depth++ == 0)
+        perf->read(start);
+    else
+        this->perf = nullptr;
+}
+
+PerfCounters::Scope::~Scope() {
+    if (perf != nullptr) {
+        uint64_t end[COUNTERS];
+        perf->read(end);
+        perf->add(phase, start, end, inputBytes);
+    }
+    if (threadEvents.depth != 0)
+        threadEvents.depth--;
+}
@@ -0,0 +1,82 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: perfcounters.hpp   Author: Dennis Lang  Desc: Hardware counters of the merge phases
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// -perfcounters counts cycles, instructions, branch and cache misses of each thread while it
+// parses, updates or writes, and reports the totals per MB of input. Linux perf_event_open only,
+// elsewhere or when not permitted the run continues without them.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include <string>
+
+#include "diagnostics.hpp"
+
+// Counters summed over the threads of each phase. Counting is per thread, so phases
+// running at the same time on pipeline threads are still attributed to their own phase.
+class PerfCounters {
+public:
+    enum Phase { PARSE, UPDATE, WRITE, PHASES };
+    enum Counter { TASK_CLOCK, CYCLES, INSTRUCTIONS, BRANCH_MISSES, L1D_MISSES, LLC_MISSES, COUNTERS };
+
+    // Probe which counters open, false if none do. Error names those which did not and why.
+    bool open(std::string& error);
+    // Per MB of input scanned, counters which did not open are left out.
+    void report(Diagnostics& diag) const;
+
+    // Count the current thread for a phase, nested scopes of a thread count once.
+    class Scope {
+    public:
+        Scope(PerfCounters* perf, Phase phase, uint64_t inputBytes = 0);
+        ~Scope();
+    private:
+        PerfCounters* perf;     // nullptr when not counting
+        Phase phase;
+        uint64_t inputBytes;
+        uint64_t start[COUNTERS];
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    bool available[COUNTERS] = {};
+    uint64_t totals[PHASES][COUNTERS] = {};
+    uint64_t bytes = 0;
+    mutable std::mutex mutex;
+
+    void read(uint64_t values[COUNTERS]) const;
+    void add(Phase phase, const uint64_t start[COUNTERS], const uint64_t end[COUNTERS], uint64_t inputBytes);
+};
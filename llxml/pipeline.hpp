@@ -0,0 +1,156 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: pipeline.hpp   Author: Dennis Lang  Desc: Bounded queue between pipeline stages
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// Files flow read -> parse -> merge through BoundedQueues. A full queue blocks its producer,
+// an empty queue its consumer, the wait counts tell which stage is the bottleneck:
+//   mostly full   - consumer stage is slower
+//   mostly empty  - producer stage is slower
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class BoundedQueue {
+public:
+    BoundedQueue(const char* _name, size_t _depth) :
+        name(_name), depth(_depth < 1 ? 1 : _depth) {
+    }
+
+    // Block while full, return false if closed.
+    bool push(T&& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        bool waited = false;
+        if (items.size() >= depth && ! closed) {
+            waited = true;
+            notFull.wait(lock, [this] { return items.size() < depth || closed; });
+        }
+        if (closed)
+            return false;
+        items.push_back(std::move(item));
+        pushes++;
+        fullWaits += waited;
+        occupancySum += items.size();
+        maxOccupancy = std::max(maxOccupancy, items.size());
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // Block while empty, return false when closed and drained.
+    // The wait of a consumer released by close() is not counted, it waited for no item.
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        bool waited = false;
+        if (items.empty() && ! closed) {
+            waited = true;
+            notEmpty.wait(lock, [this] { return ! items.empty() || closed; });
+        }
+        if (items.empty())
+            return false;
+        emptyWaits += waited;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    // Pop without blocking, return false if empty.
+    bool tryPop(T& item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty())
+            return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    // No more pushes, consumers drain what is left.
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    // Queue: read   depth=8 avg=7.2 max=8 full=90% empty=1%
+    void report(std::ostream& out) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t cnt = std::max(pushes, (size_t)1);
+        out << "Queue: " << std::left << std::setw(6) << name << std::right
+            << " depth=" << depth
+            << " avg=" << std::fixed << std::setprecision(1) << (double)occupancySum / cnt
+            << " max=" << maxOccupancy
+            << " full=" << fullWaits * 100 / cnt << "%"
+            << " empty=" << emptyWaits * 100 / cnt << "%"
+            << std::endl;
+    }
+
+    // Raw counts of report(), for -diag=json: avg is occupancy/pushes, full and empty are
+    // waits/pushes. Only waits that end in a push or pop are counted, so both are at most 100%.
+    std::vector<std::pair<std::string, uint64_t>> counts() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<std::pair<std::string, uint64_t>> values;
+        values.push_back(std::make_pair("depth", (uint64_t)depth));
+        values.push_back(std::make_pair("pushes", (uint64_t)pushes));
+        values.push_back(std::make_pair("occupancy", (uint64_t)occupancySum));
+        values.push_back(std::make_pair("max", (uint64_t)maxOccupancy));
+        values.push_back(std::make_pair("fullWaits", (uint64_t)fullWaits));
+        values.push_back(std::make_pair("emptyWaits", (uint64_t)emptyWaits));
+        return values;
+    }
+    const std::string& getName() const { return name; }
+
+private:
+    std::string name;
+    size_t depth;
+    bool closed = false;
+    std::deque<T> items;
+    mutable std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+
+    size_t pushes = 0;
+    size_t occupancySum = 0;    // occupancy after each push
+    size_t maxOccupancy = 0;
+    size_t fullWaits = 0;       // producer blocked
+    size_t emptyWaits = 0;      // consumer blocked
+};
@@ -0,0 +1,210 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: shard.cpp   Author: Dennis Lang  Desc: Split a merge across processes with -shard
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#include "shard.hpp"
+#include "json.hpp"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <set>
+#include <unordered_map>
+
+// -------------------------------------------------------------------------------------------------
+bool ShardSpec::parse(const std::string& spec) {
+    unsigned idx = 0, cnt = 0;
+    char extra;
+    if (sscanf(spec.c_str(), "%u/%u%c", &idx, &cnt, &extra) != 2 || idx < 1 || idx > cnt)
+        return false;
+    index = idx;
+    count = cnt;
+    return true;
+}
+
+bool ShardSpec::owns(const std::string& masterPath) const {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : masterPath) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash % count == index - 1;
+}
+
+std::string ShardSpec::name() const {
+    return std::to_string(index) + "/" + std::to_string(count);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Fields of a flat json line, string and number values, nested objects are skipped.
+static bool parseLine(const char* ptr, const char* end, std::map<std::string, std::string>& fields) {
+    fields.clear();
+    while (ptr < end && isspace((unsigned char)*ptr)) ptr++;
+    if (ptr == end || *ptr++ != '{')
+        return false;
+    std::string name, value;
+    while (ptr < end) {
+        while (ptr < end && (isspace((unsigned char)*ptr) || *ptr == ',')) ptr++;
+        if (ptr < end && *ptr == '}')
+            return true;
+        size_t len = Json::valueLength(ptr, end);
+        if (ptr == end || *ptr != '"' || len < 2)
+            return false;
+        Json::unescape(ptr, ptr + len, name);
+        ptr += len;
+        while (ptr < end && isspace((unsigned char)*ptr)) ptr++;
+        if (ptr == end || *ptr++ != ':')
+            return false;
+        while (ptr < end && isspace((unsigned char)*ptr)) ptr++;
+        if (ptr < end && *ptr == '{') {
+            while (ptr < end && *ptr != '}') ptr++;
+            ptr++;
+            continue;
+        }
+        len = Json::valueLength(ptr, end);
+        if (len == 0)
+            return false;
+        if (*ptr == '"')
+            Json::unescape(ptr, ptr + len, value);
+        else
+            value.assign(ptr, len);
+        ptr += len;
+        fields[name] = value;
+    }
+    return false;
+}
+
+// -------------------------------------------------------------------------------------------------
+std::string ShardReport::messageId(const Message& msg) {
+    return std::to_string(msg.category) + '\0' + msg.file + '\0' + msg.key + '\0' + msg.message;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Messages of an order are the same in every shard while merging inputs, and from a single
+// shard while writing outputs, so each is kept as often as the shard with the most of it has it.
+bool ShardReport::read(const std::string& path, std::string& error) {
+    std::ifstream inF(path);
+    if (! inF.is_open()) {
+        error = "Unable to open: " + path;
+        return false;
+    }
+
+    std::map<uint64_t, std::vector<Message>> shardMessages;
+    std::map<std::string, std::string> fields;
+    std::string line;
+    while (std::getline(inF, line)) {
+        if (! parseLine(line.data(), line.data() + line.length(), fields))
+            continue;       // not a -diag=json line
+        const std::string& category = fields["category"];
+        if (category == "stats") {
+            shards.push_back(fields["name"]);
+            for (const auto& field : fields) {
+                if (field.first == "category" || field.first == "name")
+                    continue;
+                auto total = totals.begin();
+                while (total != totals.end() && total->first != field.first)
+                    total++;
+                if (total == totals.end())
+                    total = totals.insert(totals.end(), std::make_pair(field.first, (uint64_t)0));
+                total->second += strtoull(field.second.c_str(), nullptr, 10);
+            }
+            continue;
+        }
+        Message msg;
+        if (! Diagnostics::categoryOf(category, msg.category))
+            continue;       // summary
+        msg.file = fields["file"];
+        msg.key = fields["key"];
+        msg.message = fields["message"];
+        shardMessages[strtoull(fields["order"].c_str(), nullptr, 10)].push_back(msg);
+    }
+
+    std::unordered_map<std::string, size_t> have;
+    std::unordered_map<std::string, size_t> seen;
+    for (auto& entry : shardMessages) {
+        std::vector<Message>& all = messages[entry.first];
+        if (all.empty()) {
+            all.swap(entry.second);
+            continue;
+        }
+        have.clear();
+        seen.clear();
+        for (const Message& msg : all)
+            have[messageId(msg)]++;
+        for (Message& msg : entry.second) {
+            std::string id = messageId(msg);
+            if (++seen[id] > have[id]) {
+                have[id]++;
+                all.push_back(std::move(msg));
+            }
+        }
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+bool ShardReport::report(Diagnostics& diag) const {
+    for (const auto& entry : messages) {
+        for (const Message& msg : entry.second)
+            diag.report(msg.category, msg.file, msg.key, msg.message);
+    }
+
+    // Every shard of the count, once.
+    bool complete = ! shards.empty();
+    std::set<unsigned> found;
+    unsigned count = 0;
+    for (const std::string& name : shards) {
+        ShardSpec spec;
+        if (! spec.parse(name) || (count != 0 && spec.count != count) || ! found.insert(spec.index).second) {
+            diag.report(DIAG_ERROR, "", "", "Unexpected shard report: " + name);
+            complete = false;
+        }
+        count = spec.count;
+    }
+    for (unsigned idx = 1; idx <= count; idx++) {
+        if (found.count(idx) == 0) {
+            diag.report(DIAG_ERROR, "", "", "Missing shard report: " + std::to_string(idx) + "/" + std::to_string(count));
+            complete = false;
+        }
+    }
+    if (shards.empty())
+        diag.report(DIAG_ERROR, "", "", "No shard stats found, run shards with -diag=json");
+
+    std::vector<std::pair<std::string, uint64_t>> values;
+    values.push_back(std::make_pair("shards", (uint64_t)shards.size()));
+    values.insert(values.end(), totals.begin(), totals.end());
+    diag.flush();
+    diag.stats("merged", values);
+    return complete;
+}
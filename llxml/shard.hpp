@@ -0,0 +1,87 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: shard.hpp   Author: Dennis Lang  Desc: Split a merge across processes with -shard
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// -shard=i/N keeps the masters whose path hashes to shard i, every shard still scans all
+// masters and children, so each key updates the same master as in one process, but only its
+// own masters are updated and written. -mergeShards combines the -diag=json reports of the
+// shards into the report one process gives, messages shared by all shards are kept once.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "diagnostics.hpp"
+
+// Shard index of count, 1 based as given.
+struct ShardSpec {
+    unsigned index = 1;
+    unsigned count = 1;
+
+    // Parse i/N, false if not 1 <= i <= N.
+    bool parse(const std::string& spec);
+    // FNV-1a of the path as given on the command line, the same on every machine.
+    bool owns(const std::string& masterPath) const;
+    std::string name() const;
+};
+
+// Diagnostics of -shard runs, combined in the order one process reports them.
+class ShardReport {
+public:
+    // Add the -diag=json lines of one shard, false if it can not be read.
+    bool read(const std::string& path, std::string& error);
+    // Report combined messages, then the summed stats, false if a shard is missing.
+    bool report(Diagnostics& diag) const;
+
+private:
+    struct Message {
+        DiagCategory category;
+        std::string file;
+        std::string key;
+        std::string message;
+
+        bool operator==(const Message& other) const {
+            return category == other.category && message == other.message
+                && file == other.file && key == other.key;
+        }
+    };
+    std::map<uint64_t, std::vector<Message>> messages;     // by order
+    std::vector<std::pair<std::string, uint64_t>> totals;
+    std::vector<std::string> shards;                        // stats names, i/N
+
+    static std::string messageId(const Message& msg);
+};
@@ -0,0 +1,165 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: stringpool.cpp   Author: Dennis Lang  Desc: Interned strings
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "stringpool.hpp"
+
+#include <stdint.h>
+#include <algorithm>
+#include <functional>
+
+// -------------------------------------------------------------------------------------------------
+StringPool::~StringPool() {
+    for (Shard& shard : shards) {
+        for (Entry* entry : shard.buckets) {
+            while (entry != nullptr) {
+                Entry* next = entry->next;
+                delete entry;
+                entry = next;
+            }
+        }
+    }
+}
+
+// Shard by the high bits, the buckets use the low bits.
+StringPool::Shard& StringPool::shardOf(size_t hash) {
+    return shards[((uint64_t)hash * 0x9E3779B97F4A7C15ull) >> 59];
+}
+
+void StringPool::Shard::grow() {
+    std::vector<Entry*> old(std::max<size_t>(64, buckets.size() * 2), nullptr);
+    old.swap(buckets);
+    for (Entry* entry : old) {
+        while (entry != nullptr) {
+            Entry* next = entry->next;
+            Entry*& head = bucket(entry->hash);
+            entry->next = head;
+            head = entry;
+            entry = next;
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+StringPool::Entry* StringPool::acquire(const std::string& text, std::string* owned) {
+    size_t hash = std::hash<std::string>()(text);
+    Shard& shard = shardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (! shard.buckets.empty()) {
+        for (Entry* entry = shard.bucket(hash); entry != nullptr; entry = entry->next) {
+            if (entry->hash == hash && entry->text == text) {
+                entry->refs++;
+                return entry;
+            }
+        }
+    }
+    if (shard.count >= shard.buckets.size())
+        shard.grow();
+    Entry*& head = shard.bucket(hash);
+    head = new Entry(hash, head, owned != nullptr ? std::move(*owned) : std::string(text));
+    shard.count++;
+    shard.bytes += head->text.length();
+    return head;
+}
+
+// Only the last reference takes the lock, it unlinks and frees the entry.
+void StringPool::release(Entry* entry) {
+    size_t refs = entry->refs.load();
+    while (refs > 1) {
+        if (entry->refs.compare_exchange_weak(refs, refs - 1))
+            return;
+    }
+    Shard& shard = shardOf(entry->hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (--entry->refs != 0)
+        return;
+    Entry** link = &shard.bucket(entry->hash);
+    while (*link != entry)
+        link = &(*link)->next;
+    *link = entry->next;
+    shard.count--;
+    shard.bytes -= entry->text.length();
+    delete entry;
+}
+
+// -------------------------------------------------------------------------------------------------
+size_t StringPool::size() const {
+    size_t count = 0;
+    for (const Shard& shard : shards)
+        count += shard.count;
+    return count;
+}
+
+size_t StringPool::bytes() const {
+    size_t count = 0;
+    for (const Shard& shard : shards)
+        count += shard.bytes;
+    return count;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Outlives the static values released at exit.
+StringPool* const PooledText::pool = new StringPool;
+
+void PooledText::intern() {
+    if (entry == nullptr && ! text.empty()) {
+        entry = pool->acquire(text, &text);
+        std::string().swap(text);
+    }
+}
+
+void PooledText::release() {
+    if (entry != nullptr)
+        pool->release(entry);
+    entry = nullptr;
+}
+
+PooledText& PooledText::operator=(const PooledText& other) {
+    if (this != &other) {
+        if (other.entry != nullptr)
+            other.entry->refs++;
+        release();
+        entry = other.entry;
+        text = other.text;
+    }
+    return *this;
+}
+
+PooledText& PooledText::operator=(PooledText&& other) noexcept {
+    if (this != &other) {
+        release();
+        entry = other.entry;
+        other.entry = nullptr;
+        text = std::move(other.text);
+    }
+    return *this;
+}
@@ -0,0 +1,130 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: stringpool.hpp   Author: Dennis Lang  Desc: Interned strings
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// Keys repeat across files: a child key missing from a master is recorded in the extra
+// set of that master, with many masters every child key lands in most of them. A StringPool
+// keeps one copy of each distinct string and the sets refer to it by pointer, the pointer
+// is its id: two pooled strings have equal bytes only if their pointers are equal.
+// Values repeat too, as untranslated "OK" or brand names of the same key in every locale
+// master. A PooledText holds such a statement as its own copy until interned (-intern), then
+// shares the counted pool entry of equal texts, freed with its last copy.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class StringPool {
+public:
+    struct Entry {
+        std::atomic<size_t> refs;
+        size_t hash;
+        Entry* next;            // chain of the shard bucket
+        std::string text;
+        Entry(size_t hash, Entry* next, std::string&& text) : refs(1), hash(hash), next(next), text(std::move(text)) {}
+    };
+
+    StringPool() {}
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+    ~StringPool();
+
+    // Entry of text with one more reference, added if new, then moved from owned if given.
+    // Safe to call from several threads, as is release of the last reference.
+    Entry* acquire(const std::string& text, std::string* owned = nullptr);
+    void release(Entry* entry);
+
+    // Pooled copy of str, added if new and kept as long as the pool.
+    const std::string* intern(const std::string& str) { return &acquire(str)->text; }
+
+    // Distinct strings and their total length, when no other thread is interning.
+    size_t size() const;
+    size_t bytes() const;
+
+private:
+    // Chained by hand, a lookup touches the bucket and the entries, no map nodes.
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Entry*> buckets;    // power of two, indexed by the low hash bits
+        size_t count = 0;
+        size_t bytes = 0;
+        Entry*& bucket(size_t hash) { return buckets[hash & (buckets.size() - 1)]; }
+        void grow();
+    };
+    static const size_t SHARDS = 32;    // top 5 hash bits, independent locks for shard threads
+    Shard shards[SHARDS];
+
+    Shard& shardOf(size_t hash);
+};
+
+class PooledText {
+public:
+    PooledText() {}
+    PooledText(const std::string& text) : text(text) {}
+    PooledText(std::string&& text) : text(std::move(text)) {}
+    PooledText(const PooledText& other) : text(other.text), entry(other.entry) {
+        if (entry != nullptr)
+            entry->refs++;
+    }
+    PooledText(PooledText&& other) noexcept : text(std::move(other.text)), entry(other.entry) { other.entry = nullptr; }
+    ~PooledText() { release(); }
+
+    PooledText& operator=(const PooledText& other);
+    PooledText& operator=(PooledText&& other) noexcept;
+    PooledText& operator=(const std::string& text) { return *this = PooledText(text); }
+    PooledText& operator=(std::string&& text) { return *this = PooledText(std::move(text)); }
+
+    // Share the text with the equal interned texts, frees the own copy.
+    void intern();
+
+    const std::string& str() const { return entry != nullptr ? entry->text : text; }
+    operator const std::string&() const { return str(); }
+    const char* data() const { return str().data(); }
+    size_t length() const { return str().length(); }
+    bool empty() const { return str().empty(); }
+    // Equal interned texts share an entry, which is the id of the text.
+    bool operator==(const PooledText& other) const {
+        return (entry != nullptr && other.entry != nullptr) ? entry == other.entry : str() == other.str();
+    }
+    bool operator!=(const PooledText& other) const { return ! (*this == other); }
+    const void* id() const { return entry != nullptr ? (const void*)entry : (const void*)&text; }
+
+private:
+    std::string text;                       // own copy, until interned
+    StringPool::Entry* entry = nullptr;     // shared copy, once interned
+    static StringPool* const pool;
+
+    void release();
+};
@@ -0,0 +1,177 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: textkernel_test.cpp   Author: Dennis Lang  Desc: Differential test of the text kernels
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// Runs every kernel set the cpu supports against TextKernel::Scalar on random text, lengths
+// around the 16 and 32 byte vector widths and the 256 byte hash block, white space only text,
+// embedded NULs and unaligned starts. Prints each mismatch, exit status 1 if any.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+#include "../textkernel.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static mt19937 rng(20240601);
+static size_t failures = 0;
+
+static const char WHITE[] = " \t\n\v\f\r";
+static const char TEXT[] = "ab< >\"\\\n\t\r\0";     // includes its terminating NUL
+
+// -------------------------------------------------------------------------------------------------
+static string show(const string& str) {
+    string out;
+    for (unsigned char c : str.substr(0, 80)) {
+        char hex[8];
+        snprintf(hex, sizeof(hex), c >= ' ' && c < 127 ? "%c" : "\\x%02x", c);
+        out += hex;
+    }
+    return str.length() > 80 ? out + "..." : out;
+}
+
+static void fail(const char* isa, const char* kernel, const string& str1, const string& str2 = "") {
+    if (failures++ < 20) {
+        printf("FAIL %s %s len=%zu [%s]", isa, kernel, str1.length(), show(str1).c_str());
+        if (! str2.empty())
+            printf(" [%s]", show(str2).c_str());
+        printf("\n");
+    }
+}
+
+// Lengths around the 16 and 32 byte vectors, the 256 byte hash block and larger.
+static vector<size_t> lengths() {
+    vector<size_t> lens;
+    for (size_t len = 0; len <= 70; len++)
+        lens.push_back(len);
+    for (size_t len : { 96, 128, 255, 256, 257, 511, 512, 513, 1000, 4099 }) {
+        lens.push_back(len - 1);
+        lens.push_back(len);
+    }
+    return lens;
+}
+
+static string randomText(size_t len, const char* alphabet, size_t alphabetLen) {
+    string str(len, ' ');
+    for (char& c : str)
+        c = alphabetLen == 0 ? (char)(rng() & 0xff) : alphabet[rng() % alphabetLen];
+    return str;
+}
+
+// Same text with white space added, removed or changed, usually equal ignoring white.
+static string reshapeWhite(const string& str) {
+    string out;
+    for (char c : str) {
+        unsigned pick = rng() % 8;
+        if (strchr(WHITE, c) != nullptr && c != 0 && pick < 3)
+            continue;
+        out += c;
+        if (pick == 7)
+            out += WHITE[rng() % 6];
+    }
+    if (! out.empty() && rng() % 4 == 0)
+        out[rng() % out.length()] ^= 1;
+    return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Run set's kernels on str at offset within a buffer whose bytes past the end would change a
+// result read beyond len.
+static void check(const TextKernel::Kernels& set, const string& str, size_t offset) {
+    namespace Scalar = TextKernel::Scalar;
+    vector<char> buf(offset + str.length() + 64, '\n');
+    for (size_t idx = 0; idx < 64; idx += 2)
+        buf[offset + str.length() + idx] = '"';
+    memcpy(buf.data() + offset, str.data(), str.length());
+    const char* ptr = buf.data() + offset;
+    size_t len = str.length();
+
+    if (set.countNewlines(ptr, len) != Scalar::countNewlines(ptr, len))
+        fail(set.isa, "countNewlines", str);
+
+    vector<char> out1(len + 1, 'x');
+    vector<char> out2(len + 1, 'x');
+    size_t len1 = set.stripNewlines(out1.data(), ptr, len);
+    size_t len2 = Scalar::stripNewlines(out2.data(), ptr, len);
+    if (len1 != len2 || memcmp(out1.data(), out2.data(), len2) != 0)
+        fail(set.isa, "stripNewlines", str);
+
+    if (set.hashIgnoreWhite(ptr, len) != Scalar::hashIgnoreWhite(ptr, len))
+        fail(set.isa, "hashIgnoreWhite", str);
+
+    if (set.findQuote(ptr, len) != Scalar::findQuote(ptr, len))
+        fail(set.isa, "findQuote", str);
+
+    // Both orders, the reference keeps the original walk which ignores trailing white space
+    // of the second string only when the first has some left.
+    string other = reshapeWhite(str);
+    bool equal = Scalar::equalIgnoreWhite(ptr, len, other.data(), other.length());
+    if (set.equalIgnoreWhite(ptr, len, other.data(), other.length()) != equal)
+        fail(set.isa, "equalIgnoreWhite", str, other);
+    if (set.equalIgnoreWhite(other.data(), other.length(), ptr, len)
+            != Scalar::equalIgnoreWhite(other.data(), other.length(), ptr, len))
+        fail(set.isa, "equalIgnoreWhite", other, str);
+    if (equal && set.hashIgnoreWhite(ptr, len) != set.hashIgnoreWhite(other.data(), other.length()))
+        fail(set.isa, "hashIgnoreWhite of equal", str, other);
+}
+
+// -------------------------------------------------------------------------------------------------
+int main() {
+    vector<string> inputs;
+    for (size_t len : lengths()) {
+        for (int run = 0; run < 4; run++) {
+            inputs.push_back(randomText(len, nullptr, 0));
+            inputs.push_back(randomText(len, TEXT, sizeof(TEXT)));
+            inputs.push_back(randomText(len, WHITE, 6));
+        }
+        inputs.push_back(string(len, ' '));
+        inputs.push_back(string(len, '\n'));
+        inputs.push_back(string(len, '\0'));
+    }
+
+    for (const TextKernel::Kernels& set : TextKernel::supported()) {
+        size_t cases = 0;
+        size_t before = failures;
+        for (const string& str : inputs) {
+            for (size_t offset = 0; offset < 33; offset += (str.length() > 300 ? 11 : 1)) {
+                check(set, str, offset);
+                cases++;
+            }
+        }
+        printf("%-8s %s, %zu cases\n", set.isa, failures == before ? "ok" : "FAILED", cases);
+    }
+    return failures == 0 ? 0 : 1;
+}
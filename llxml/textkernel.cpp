@@ -0,0 +1,534 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: textkernel.cpp   Author: Dennis Lang  Desc: Vectorized text kernels
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "textkernel.hpp"
+
+#include <string.h>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define HAVE_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define TARGET_SSE42
+        #define TARGET_AVX2
+        #define popCount(x) __popcnt(x)
+        static inline unsigned lowBit(unsigned x) { unsigned long idx; _BitScanForward(&idx, x); return (unsigned)idx; }
+    #else
+        #define TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+        #define TARGET_AVX2  __attribute__((target("avx2,popcnt")))
+        #define popCount(x) __builtin_popcount(x)
+        #define lowBit(x) (unsigned)__builtin_ctz(x)
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define HAVE_NEON
+    #include <arm_neon.h>
+#endif
+
+typedef size_t (*EqualRun)(const char* ptr1, const char* ptr2, size_t len);
+typedef const char* (*PackWhite)(char* out, const char* in, const char* inEnd);
+
+// Hash of packed (white space removed) bytes, 8 bytes per step.
+static const uint64_t HASH_SEED = 14695981039346656037ULL;
+static const uint64_t HASH_MUL = 0x9E3779B97F4A7C15ULL;
+static const size_t PACK_BLOCK = 256;
+
+// -------------------------------------------------------------------------------------------------
+// Same set as isspace() in the C locale: ' ', '\t', '\n', '\v', '\f', '\r'
+static inline bool isWhite(char c) {
+    return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+// -------------------------------------------------------------------------------------------------
+static inline uint64_t hashWord(uint64_t hash, uint64_t word) {
+    hash = (hash ^ word) * HASH_MUL;
+    return hash ^ (hash >> 32);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Hash whole words of packed, return number of bytes consumed (multiple of 8).
+static size_t hashWords(uint64_t& hash, const char* packed, size_t len) {
+    size_t used = len & ~size_t(7);
+    for (size_t idx = 0; idx < used; idx += 8) {
+        uint64_t word;
+        memcpy(&word, packed + idx, 8);
+        hash = hashWord(hash, word);
+    }
+    return used;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Pack input through packWhite in blocks and hash the packed stream.
+static uint64_t hashPacked(PackWhite packWhite, const char* ptr, size_t len) {
+    char packed[PACK_BLOCK + 64];
+    uint64_t hash = HASH_SEED;
+    size_t total = 0;
+    size_t have = 0;
+    const char* endPtr = ptr + len;
+
+    while (ptr < endPtr) {
+        const char* inEnd = std::min(endPtr, ptr + PACK_BLOCK);
+        have = packWhite(packed + have, ptr, inEnd) - packed;
+        ptr = inEnd;
+        size_t used = hashWords(hash, packed, have);
+        total += used;
+        have -= used;
+        memmove(packed, packed + used, have);
+    }
+
+    uint64_t word = 0;
+    memcpy(&word, packed, have);
+    total += have;
+    hash = hashWord(hash, word ^ total);
+    return hash * HASH_MUL;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Reference compare loop, ptr1/ptr2 advanced past equal runs reported by equalRun.
+static bool equalIgnoreWhiteRun(EqualRun equalRun,
+        const char* p1, const char* end1, const char* p2, const char* end2) {
+    while (p1 < end1) {
+        if (equalRun != nullptr) {
+            size_t run = equalRun(p1, p2, std::min<size_t>(end1 - p1 - 1, end2 - p2));
+            p1 += run;
+            p2 += run;
+        }
+        while (p1 < end1 && isWhite(*p1)) p1++;
+        while (p2 < end2 && isWhite(*p2)) p2++;
+        if (p1 == end1 || p2 == end2)
+            return p1 == end1 && p2 == end2;
+        if (*p1 != *p2)
+            return false;
+        p1++;
+        p2++;
+    }
+    return p2 == end2;
+}
+
+// =================================================================================================
+// Scalar reference
+
+// -------------------------------------------------------------------------------------------------
+size_t TextKernel::Scalar::countNewlines(const char* ptr, size_t len) {
+    return (size_t)std::count(ptr, ptr + len, '\n');
+}
+
+// -------------------------------------------------------------------------------------------------
+size_t TextKernel::Scalar::stripNewlines(char* out, const char* in, size_t len) {
+    size_t oIdx = 0;
+    for (size_t idx = 0; idx < len; idx++) {
+        if (in[idx] != '\n') {
+            out[oIdx++] = in[idx];
+        }
+    }
+    return oIdx;
+}
+
+// -------------------------------------------------------------------------------------------------
+bool TextKernel::Scalar::equalIgnoreWhite(const char* str1, size_t len1, const char* str2, size_t len2) {
+    return equalIgnoreWhiteRun(nullptr, str1, str1 + len1, str2, str2 + len2);
+}
+
+// -------------------------------------------------------------------------------------------------
+static const char* packWhiteScalar(char* out, const char* in, const char* inEnd) {
+    for (; in < inEnd; in++) {
+        if (! isWhite(*in))
+            *out++ = *in;
+    }
+    return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+uint64_t TextKernel::Scalar::hashIgnoreWhite(const char* ptr, size_t len) {
+    return hashPacked(packWhiteScalar, ptr, len);
+}
+
+// -------------------------------------------------------------------------------------------------
+size_t TextKernel::Scalar::findQuote(const char* ptr, size_t len) {
+    for (size_t idx = 0; idx < len; idx++) {
+        if (ptr[idx] == '"' || ptr[idx] == '\\')
+            return idx;
+    }
+    return len;
+}
+
+#ifdef HAVE_X86
+// =================================================================================================
+// SSE4.2 (16 byte) and AVX2 (32 byte)
+
+// -------------------------------------------------------------------------------------------------
+// Shuffle control to move kept bytes of an 8 byte lane to the front, indexed by keep mask.
+static const uint8_t* packTable() {
+    static uint8_t table[256 * 8];
+    static bool ready = [] {
+        for (unsigned mask = 0; mask < 256; mask++) {
+            uint8_t* ctrl = table + mask * 8;
+            unsigned cnt = 0;
+            for (unsigned bit = 0; bit < 8; bit++) {
+                if (mask & (1 << bit))
+                    ctrl[cnt++] = (uint8_t)bit;
+            }
+            while (cnt < 8)
+                ctrl[cnt++] = 0x80;
+        }
+        return true;
+    }();
+    (void)ready;
+    return table;
+}
+
+// -------------------------------------------------------------------------------------------------
+TARGET_SSE42 static inline __m128i whiteMask128(__m128i block) {
+    __m128i space = _mm_cmpeq_epi8(block, _mm_set1_epi8(' '));
+    __m128i ctrl = _mm_sub_epi8(block, _mm_set1_epi8('\t'));
+    __m128i inRange = _mm_cmpeq_epi8(_mm_min_epu8(ctrl, _mm_set1_epi8('\r' - '\t')), ctrl);
+    return _mm_or_si128(space, inRange);
+}
+
+// -------------------------------------------------------------------------------------------------
+TARGET_SSE42 static size_t countNewlinesSse42(const char* ptr, size_t len) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t count = 0;
+    size_t idx = 0;
+    for (; idx + 16 <= len; idx += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(ptr + idx));
+        count += popCount((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+    }
+    return count + TextKernel::Scalar::countNewlines(ptr + idx, len - idx);
+}
+
+// -------------------------------------------------------------------------------------------------
+TARGET_SSE42 static size_t stripNewlinesSse42(char* out, const char* in, size_t len) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    char* outPtr = out;
+    size_t idx = 0;
+    for (; idx + 16 <= len; idx += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(in + idx));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)) == 0) {
+            _mm_storeu_si128((__m128i*)outPtr, block);
+            outPtr += 16;
+        } else {
+            outPtr += TextKernel::Scalar::stripNewlines(outPtr, in + idx, 16);
+        }
+    }
+    outPtr += TextKernel::Scalar::stripNewlines(outPtr, in + idx, len - idx);
+    return outPtr - out;
+}
+
+// -------------------------------------------------------------------------------------------------
+TARGET_SSE42 static size_t equalRunSse42(const char* ptr1, const char* ptr2, size_t len) {
+    size_t idx = 0;
+    for (; idx + 16 <= len; idx += 16) {
+        __m128i block1 = _mm_loadu_si128((const __m128i*)(ptr1 + idx));
+        __m128i block2 = _mm_loadu_si128((const __m128i*)(ptr2 + idx));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(block1, block2)) != 0xffff)
+            break;
+    }
+    return idx;
+}
+
+// -------------------------------------------------------------------------------------------------
+TARGET_SSE42 static bool equalIgnoreWhiteSse42(const char* str1, size_t len1, const char* str2, size_t len2) {
+    return equalIgnoreWhiteRun(equalRunSse42, str1, str1 + len1, str2, str2 + len2);
+}
+
+// -------------------------------------------------------------------------------------------------
+TARGET_SSE42 static const char* packWhiteSse42(char* out, const char* in, const char* inEnd) {
+    const uint8_t* table = packTable();
+    for (; in + 16 <= inEnd; in += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)in);
+        unsigned keep = ~(unsigned)_mm_movemask_epi8(whiteMask128(block)) & 0xffff;
+        if (keep == 0xffff) {
+            _mm_storeu_si128((__m128i*)out, block);
+            out += 16;
+        } else if (keep != 0) {
+            __m128i lo = _mm_shuffle_epi8(block, _mm_loadl_epi64((const __m128i*)(table + (keep & 0xff) * 8)));
+            _mm_storel_epi64((__m128i*)out, lo);
+            out += popCount(keep & 0xff);
+            __m128i hi = _mm_shuffle_epi8(_mm_srli_si128(block, 8), _mm_loadl_epi64((const __m128i*)(table + (keep >> 8) * 8)));
+            _mm_storel_epi64((__m128i*)out, hi);
+            out += popCount(keep >> 8);
+        }
+    }
+    return packWhiteScalar(out, in, inEnd);
+}
+
+// -------------------------------------------------------------------------------------------------
+TARGET_SSE42 static uint64_t hashIgnoreWhiteSse42(const char* ptr, size_t len) {
+    return hashPacked(packWhiteSse42, ptr, len);
+}
+
+// -------------------------------------------------------------------------------------------------
+TARGET_SSE42 static size_t findQuoteSse42(const char* ptr, size_t len) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i escape = _mm_set1_epi8('\\');
+    size_t idx = 0;
+    for (; idx + 16 <= len; idx += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(ptr + idx));
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, escape)));
+        if (mask != 0)
+            return idx + lowBit(mask);
+    }
+    return idx + TextKernel::Scalar::findQuote(ptr + idx, len - idx);
+}
+
+// -------------------------------------------------------------------------------------------------
+TARGET_AVX2 static size_t countNewlinesAvx2(const char* ptr, size_t len) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t count = 0;
+    size_t idx = 0;
+    for (; idx + 32 <= len; idx += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(ptr + idx));
+        count += popCount((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline)));
+    }
+    return count + countNewlinesSse42(ptr + idx, len - idx);
+}
+
+// -------------------------------------------------------------------------------------------------
+TARGET_AVX2 static size_t stripNewlinesAvx2(char* out, const char* in, size_t len) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    char* outPtr = out;
+    size_t idx = 0;
+    for (; idx + 32 <= len; idx += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(in + idx));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline)) == 0) {
+            _mm256_storeu_si256((__m256i*)outPtr, block);
+            outPtr += 32;
+        } else {
+            outPtr += TextKernel::Scalar::stripNewlines(outPtr, in + idx, 32);
+        }
+    }
+    outPtr += stripNewlinesSse42(outPtr, in + idx, len - idx);
+    return outPtr - out;
+}
+
+// -------------------------------------------------------------------------------------------------
+TARGET_AVX2 static size_t equalRunAvx2(const char* ptr1, const char* ptr2, size_t len) {
+    size_t idx = 0;
+    for (; idx + 32 <= len; idx += 32) {
+        __m256i block1 = _mm256_loadu_si256((const __m256i*)(ptr1 + idx));
+        __m256i block2 = _mm256_loadu_si256((const __m256i*)(ptr2 + idx));
+        if ((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block1, block2)) != 0xffffffff)
+            break;
+    }
+    return idx + equalRunSse42(ptr1 + idx, ptr2 + idx, len - idx);
+}
+
+// -------------------------------------------------------------------------------------------------
+TARGET_AVX2 static bool equalIgnoreWhiteAvx2(const char* str1, size_t len1, const char* str2, size_t len2) {
+    return equalIgnoreWhiteRun(equalRunAvx2, str1, str1 + len1, str2, str2 + len2);
+}
+
+// -------------------------------------------------------------------------------------------------
+TARGET_AVX2 static size_t findQuoteAvx2(const char* ptr, size_t len) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i escape = _mm256_set1_epi8('\\');
+    size_t idx = 0;
+    for (; idx + 32 <= len; idx += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(ptr + idx));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, escape)));
+        if (mask != 0)
+            return idx + lowBit(mask);
+    }
+    return idx + findQuoteSse42(ptr + idx, len - idx);
+}
+
+// -------------------------------------------------------------------------------------------------
+static bool cpuHas(bool avx2) {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    bool sse42 = (info[2] & (1 << 20)) != 0 && (info[2] & (1 << 23)) != 0;
+    if (! avx2)
+        return sse42;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    __cpuidex(info, 7, 0);
+    return sse42 && osxsave && (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 6) == 6;
+#else
+    __builtin_cpu_init();
+    return avx2
+        ? __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")
+        : __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+#endif
+}
+#endif  // HAVE_X86
+
+#ifdef HAVE_NEON
+// =================================================================================================
+// NEON (16 byte)
+
+// -------------------------------------------------------------------------------------------------
+static inline uint8x16_t whiteMaskNeon(uint8x16_t block) {
+    uint8x16_t space = vceqq_u8(block, vdupq_n_u8(' '));
+    uint8x16_t inRange = vcleq_u8(vsubq_u8(block, vdupq_n_u8('\t')), vdupq_n_u8('\r' - '\t'));
+    return vorrq_u8(space, inRange);
+}
+
+// -------------------------------------------------------------------------------------------------
+static size_t countNewlinesNeon(const char* ptr, size_t len) {
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    size_t count = 0;
+    size_t idx = 0;
+    for (; idx + 16 <= len; idx += 16) {
+        uint8x16_t block = vld1q_u8((const uint8_t*)(ptr + idx));
+        count += vaddvq_u8(vshrq_n_u8(vceqq_u8(block, newline), 7));
+    }
+    return count + TextKernel::Scalar::countNewlines(ptr + idx, len - idx);
+}
+
+// -------------------------------------------------------------------------------------------------
+static size_t stripNewlinesNeon(char* out, const char* in, size_t len) {
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    char* outPtr = out;
+    size_t idx = 0;
+    for (; idx + 16 <= len; idx += 16) {
+        uint8x16_t block = vld1q_u8((const uint8_t*)(in + idx));
+        if (vmaxvq_u8(vceqq_u8(block, newline)) == 0) {
+            vst1q_u8((uint8_t*)outPtr, block);
+            outPtr += 16;
+        } else {
+            outPtr += TextKernel::Scalar::stripNewlines(outPtr, in + idx, 16);
+        }
+    }
+    outPtr += TextKernel::Scalar::stripNewlines(outPtr, in + idx, len - idx);
+    return outPtr - out;
+}
+
+// -------------------------------------------------------------------------------------------------
+static size_t equalRunNeon(const char* ptr1, const char* ptr2, size_t len) {
+    size_t idx = 0;
+    for (; idx + 16 <= len; idx += 16) {
+        uint8x16_t block1 = vld1q_u8((const uint8_t*)(ptr1 + idx));
+        uint8x16_t block2 = vld1q_u8((const uint8_t*)(ptr2 + idx));
+        if (vminvq_u8(vceqq_u8(block1, block2)) != 0xff)
+            break;
+    }
+    return idx;
+}
+
+// -------------------------------------------------------------------------------------------------
+static bool equalIgnoreWhiteNeon(const char* str1, size_t len1, const char* str2, size_t len2) {
+    return equalIgnoreWhiteRun(equalRunNeon, str1, str1 + len1, str2, str2 + len2);
+}
+
+// -------------------------------------------------------------------------------------------------
+static const char* packWhiteNeon(char* out, const char* in, const char* inEnd) {
+    for (; in + 16 <= inEnd; in += 16) {
+        uint8x16_t block = vld1q_u8((const uint8_t*)in);
+        if (vmaxvq_u8(whiteMaskNeon(block)) == 0) {
+            vst1q_u8((uint8_t*)out, block);
+            out += 16;
+        } else {
+            out = (char*)packWhiteScalar(out, in, in + 16);
+        }
+    }
+    return packWhiteScalar(out, in, inEnd);
+}
+
+// -------------------------------------------------------------------------------------------------
+static size_t findQuoteNeon(const char* ptr, size_t len) {
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t escape = vdupq_n_u8('\\');
+    size_t idx = 0;
+    for (; idx + 16 <= len; idx += 16) {
+        uint8x16_t block = vld1q_u8((const uint8_t*)(ptr + idx));
+        if (vmaxvq_u8(vorrq_u8(vceqq_u8(block, quote), vceqq_u8(block, escape))) != 0)
+            return idx + TextKernel::Scalar::findQuote(ptr + idx, 16);
+    }
+    return idx + TextKernel::Scalar::findQuote(ptr + idx, len - idx);
+}
+
+// -------------------------------------------------------------------------------------------------
+static uint64_t hashIgnoreWhiteNeon(const char* ptr, size_t len) {
+    return hashPacked(packWhiteNeon, ptr, len);
+}
+#endif  // HAVE_NEON
+
+// =================================================================================================
+// Runtime dispatch, selected on first use.
+
+using TextKernel::Kernels;
+
+// -------------------------------------------------------------------------------------------------
+std::vector<Kernels> TextKernel::supported() {
+    std::vector<Kernels> sets;
+#if defined(HAVE_X86)
+    if (cpuHas(true)) {
+        sets.push_back(Kernels{ "avx2", countNewlinesAvx2, stripNewlinesAvx2, equalIgnoreWhiteAvx2,
+            hashIgnoreWhiteSse42, findQuoteAvx2 });
+    }
+    if (cpuHas(false)) {
+        sets.push_back(Kernels{ "sse4.2", countNewlinesSse42, stripNewlinesSse42, equalIgnoreWhiteSse42,
+            hashIgnoreWhiteSse42, findQuoteSse42 });
+    }
+#elif defined(HAVE_NEON)
+    sets.push_back(Kernels{ "neon", countNewlinesNeon, stripNewlinesNeon, equalIgnoreWhiteNeon,
+        hashIgnoreWhiteNeon, findQuoteNeon });
+#endif
+    sets.push_back(Kernels{ "scalar", TextKernel::Scalar::countNewlines, TextKernel::Scalar::stripNewlines,
+        TextKernel::Scalar::equalIgnoreWhite, TextKernel::Scalar::hashIgnoreWhite, TextKernel::Scalar::findQuote });
+    return sets;
+}
+
+// -------------------------------------------------------------------------------------------------
+static const Kernels& kernels() {
+    static const Kernels selected = TextKernel::supported().front();
+    return selected;
+}
+
+// -------------------------------------------------------------------------------------------------
+size_t TextKernel::countNewlines(const char* ptr, size_t len) {
+    return kernels().countNewlines(ptr, len);
+}
+
+// -------------------------------------------------------------------------------------------------
+size_t TextKernel::stripNewlines(char* out, const char* in, size_t len) {
+    return kernels().stripNewlines(out, in, len);
+}
+
+// -------------------------------------------------------------------------------------------------
+bool TextKernel::equalIgnoreWhite(const char* str1, size_t len1, const char* str2, size_t len2) {
+    return kernels().equalIgnoreWhite(str1, len1, str2, len2);
+}
+
+// -------------------------------------------------------------------------------------------------
+uint64_t TextKernel::hashIgnoreWhite(const char* ptr, size_t len) {
+    return kernels().hashIgnoreWhite(ptr, len);
+}
+
+// -------------------------------------------------------------------------------------------------
+size_t TextKernel::findQuote(const char* ptr, size_t len) {
+    return kernels().findQuote(ptr, len);
+}
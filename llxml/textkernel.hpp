@@ -0,0 +1,79 @@
+//-------------------------------------------------------------------------------------------------
+//
+// File: textkernel.hpp   Author: Dennis Lang  Desc: Vectorized text kernels
+//
+//-------------------------------------------------------------------------------------------------
+//
+// Author: Dennis Lang - 2026
+// https://landenlabs.com
+//
+// This file is part of llxml project.
+//
+// Kernels run on every scanned statement. Each has a scalar reference in TextKernel::Scalar,
+// the unqualified functions dispatch at runtime to AVX2, SSE4.2 or NEON when available.
+//
+// ----- License ----
+//
+// Copyright (c) 2026 Dennis Lang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+// of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace TextKernel {
+
+ // Count '\n' in [ptr, ptr+len)
+ size_t countNewlines(const char* ptr, size_t len);
+
+ // Copy [in, in+len) to out without '\n', return length written. out holds len bytes.
+ size_t stripNewlines(char* out, const char* in, size_t len);
+
+ // Compare ignoring white space (isspace), same result as the original char walk.
+ bool equalIgnoreWhite(const char* str1, size_t len1, const char* str2, size_t len2);
+
+ // Hash of the non white space bytes, equal for strings equalIgnoreWhite() matches.
+ uint64_t hashIgnoreWhite(const char* ptr, size_t len);
+
+ // Offset of the first '"' or '\\' in [ptr, ptr+len), len if none. Skips json string text.
+ size_t findQuote(const char* ptr, size_t len);
+
+ namespace Scalar {
+  size_t countNewlines(const char* ptr, size_t len);
+  size_t stripNewlines(char* out, const char* in, size_t len);
+  bool equalIgnoreWhite(const char* str1, size_t len1, const char* str2, size_t len2);
+  uint64_t hashIgnoreWhite(const char* ptr, size_t len);
+  size_t findQuote(const char* ptr, size_t len);
+ }
+
+ // Kernels of one instruction set.
+ struct Kernels {
+  const char* isa;
+  size_t (*countNewlines)(const char* ptr, size_t len);
+  size_t (*stripNewlines)(char* out, const char* in, size_t len);
+  bool (*equalIgnoreWhite)(const char* str1, size_t len1, const char* str2, size_t len2);
+  uint64_t (*hashIgnoreWhite)(const char* ptr, size_t len);
+  size_t (*findQuote)(const char* ptr, size_t len);
+ };
+
+ // Sets this cpu runs, best first and scalar last. The first is the one dispatched.
+ std::vector<Kernels> supported();
+}
@@ -0,0 +1,50 @@
+#!/bin/bash
+# Time builds of llxml on the training run, best of 5, and check they write the same outputs.
+# Then list the -perfcounters lines of each build's last run, per MB of input.
+#
+#   bash train/compare.sh <corpus dir> <baseline llxml> <llxml>...
+
+dir=$1
+shift
+base=$1
+TIMEFORMAT=%R
+best=""
+perf=""
+
+# -diag=json perf lines as: phase name=value...
+perfLines() {
+    sed -e 's/[{}"]//g' "$1" | awk -F, '{
+        line = ""
+        for (i = 1; i <= NF; i++) {
+            split($i, kv, ":")
+            if (kv[1] == "name") phase = kv[2]
+            else if (kv[1] != "category" && kv[1] != "bytes") line = line " " kv[1] "=" kv[2]
+        }
+        printf "%-8s%s\n", phase, line
+    }'
+}
+
+printf "%-18s %8s %8s\n" build seconds speedup
+for bin in "$@"; do
+    secs=""
+    for run in 1 2 3 4 5; do
+        t=$( { time sh train/run.sh "$bin" "$dir" ; } 2>&1 )
+        secs=$(echo "$secs $t" | awk '{ m = $1; for (i = 2; i <= NF; i++) if ($i < m) m = $i; print m }')
+    done
+    if [ "$bin" = "$base" ]; then
+        best=$secs
+        rm -rf "$dir/expect" && cp -R "$dir/out" "$dir/expect"
+    elif ! diff -r -q "$dir/expect" "$dir/out" > /dev/null; then
+        echo "$bin outputs differ from $base"
+        exit 1
+    fi
+    printf "%-18s %8s %7.2fx\n" "$bin" "$secs" \
+        "$(echo "$best $secs" | awk '{ print $1 / $2 }')"
+    for run in serial threads; do
+        perf="$perf$(perfLines "$dir/perf/$run.json" | sed -e "s|^|$(printf '%-18s %-8s ' "$bin" $run)|")
+"
+    done
+done
+
+printf "\n%-18s %-8s %-8s %s\n" build run phase "counters per MB"
+printf "%s" "$perf"
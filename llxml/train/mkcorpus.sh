@@ -0,0 +1,110 @@
+#!/bin/sh
+# Generate the synthetic resource corpus used to train and compare builds, see Makefile pgo.
+# Same files on every machine, values come from a Park-Miller generator and not awk's rand.
+#
+#   sh train/mkcorpus.sh <dir>
+#   <dir>/main       masters  values/strings.xml, values/arrays.xml, app.json
+#   <dir>/lang       children values-<locale>/strings.xml, arrays.xml, <locale>/app.json
+
+dir=${1:-obj/train}
+rm -rf "$dir"
+mkdir -p "$dir/main/values" "$dir/lang"
+
+awk -v dir="$dir" '
+function rnd(n) {
+    seed = (seed * 16807) % 2147483647
+    return seed % n
+}
+function words(cnt,   out, i) {
+    out = WORDS[1 + rnd(NWORDS)]
+    for (i = 1; i < cnt; i++)
+        out = out " " WORDS[1 + rnd(NWORDS)]
+    return out
+}
+# Text as found in resources, with format arguments, entities and escaped quotes.
+function text(lang,   t, r) {
+    t = words(2 + rnd(12))
+    r = rnd(10)
+    if (r == 0) t = t " %1$s"
+    else if (r == 1) t = "%d " t
+    else if (r == 2) t = t " &amp; " words(2)
+    else if (r == 3) t = t " \\\x27" words(1) "\\\x27"
+    return lang == "" ? t : lang ": " t
+}
+function strings(path, lang, keep,   f, k) {
+    f = path
+    print "<?xml version=\"1.0\" encoding=\"utf-8\"?>" > f
+    print "<resources xmlns:tools=\"http://schemas.android.com/tools\">" > f
+    for (k = 0; k < NSTRINGS; k++) {
+        if (lang != "" && rnd(100) >= keep)
+            continue
+        if (k % 50 == 0)
+            print "    <!-- section " k / 50 " -->" > f
+        if (lang == "" && k % 40 == 7)
+            print "    <string name=\"key_" k "\" translatable=\"false\">" text(lang) "</string>" > f
+        else
+            print "    <string name=\"key_" k "\">" text(lang) "</string>" > f
+        if (k % 25 == 3) {
+            print "    <plurals name=\"count_" k "\">" > f
+            print "        <item quantity=\"one\">%d " text(lang) "</item>" > f
+            print "        <item quantity=\"other\">%d " text(lang) "</item>" > f
+            print "    </plurals>" > f
+        }
+    }
+    if (lang != "") {
+        for (k = 0; k < 20; k++)
+            print "    <string name=\"extra_" lang "_" k "\">" text(lang) "</string>" > f
+    }
+    print "</resources>" > f
+    close(f)
+}
+function arrays(path, lang,   f, a, i) {
+    f = path
+    print "<?xml version=\"1.0\" encoding=\"utf-8\"?>" > f
+    print "<resources>" > f
+    for (a = 0; a < NARRAYS; a++) {
+        print "    <string-array name=\"list_" a "\">" > f
+        for (i = 0; i < 3 + a % 7; i++)
+            print "        <item>" text(lang) "</item>" > f
+        print "    </string-array>" > f
+    }
+    print "</resources>" > f
+    close(f)
+}
+function json(path, lang, keep,   f, g, k, sep) {
+    f = path
+    print "{" > f
+    sep = ""
+    for (g = 0; g < NGROUPS; g++) {
+        printf "%s  \"group%d\": {\n", sep, g > f
+        printf "    \"title\": \"%s\"", text(lang) > f
+        for (k = 0; k < 30; k++) {
+            if (lang == "" || rnd(100) < keep)
+                printf ",\n    \"item%d\": \"%s\"", k, text(lang) > f
+        }
+        printf ",\n    \"tags\": [\"%s\", \"%s\"]\n  }", words(1), words(1) > f
+        sep = ",\n"
+    }
+    print "\n}" > f
+    close(f)
+}
+BEGIN {
+    seed = 20240601
+    NSTRINGS = 6000; NARRAYS = 300; NGROUPS = 200
+    NWORDS = split("the your drive radar map storm alert rain wind cloud forecast hour day week " \
+        "open close save share delete settings location update now later today tomorrow warning " \
+        "temperature humidity pressure snow sunny layer legend speed direction notice error retry", WORDS)
+    NLOCALES = split("de es fr it ja ko nl pl pt-rBR ru sv tr zh-rCN zh-rTW", LOCALES)
+
+    strings(dir "/main/values/strings.xml", "", 100)
+    arrays(dir "/main/values/arrays.xml", "")
+    json(dir "/main/app.json", "", 100)
+    for (l = 1; l <= NLOCALES; l++) {
+        loc = LOCALES[l]
+        res = dir "/lang/values-" loc
+        system("mkdir -p " res " " dir "/lang/" loc)
+        strings(res "/strings.xml", loc, 70 + l)
+        arrays(res "/arrays.xml", loc)
+        json(dir "/lang/" loc "/app.json", loc, 70 + l)
+    }
+}'
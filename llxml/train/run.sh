@@ -0,0 +1,19 @@
+#!/bin/sh
+# Training run of the pgo build, also the workload timed by compare.sh.
+# Serial and threaded merges, so both code paths are profiled.
+# The -perfcounters lines of each merge are kept as -diag=json in <corpus dir>/perf.
+#
+#   sh train/run.sh <llxml> <corpus dir>
+
+bin=$1
+dir=${2:-obj/train}
+out=$dir/out
+perf=$dir/perf
+
+rm -rf "$out" "$perf"
+mkdir -p "$perf"
+"$bin" -perfcounters -diag=json -outFmt="$out/serial/%n" -csv="$out/serial/keys.csv" \
+    "$dir/main" , "$dir/lang" 2>&1 > /dev/null | grep '"category":"perf"' > "$perf/serial.json"
+"$bin" -perfcounters -diag=json -threads=4 -outFmt="$out/threads/%n" \
+    "$dir/main" , "$dir/lang" 2>&1 > /dev/null | grep '"category":"perf"' > "$perf/threads.json"
+exit 0
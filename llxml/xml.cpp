@@ -61,16 +61,25 @@
 
 #include "xml.hpp"
 
+#include <ctype.h>
 #include <errno.h>
 #include <stdio.h>
 #include <exception>
 #include <iostream>
 #include <fstream>
-#include <regex>
+#include <iterator>
+#include <atomic>
+#include <thread>
 
 #include "directory.hpp"
 #include "ll_stdhdr.hpp"
 #include "fileutil.hpp"
+#include "textkernel.hpp"
+#include "stringpool.hpp"
+#include "csvwriter.hpp"
+#include "json.hpp"
+#include "journal.hpp"
+#include "perfcounters.hpp"
 
 #ifdef HAVE_WIN
     #include <windows.h>
@@ -80,65 +89,215 @@
 #else
 #endif
 
-#if 1
-static std::regex_constants::match_flag_type rxFlags =
-    std::regex_constants::match_flag_type(std::regex_constants::match_default +
-        std::regex_constants::extended);
-#else
-static std::regex_constants::match_flag_type rxFlags =
-    std::regex_constants::match_flag_type(std::regex_constants::match_default +
-        std::regex_constants::match_not_eol +
-        std::regex_constants::match_not_bol);
-#endif
-
 #define sizeStr(x)  sizeof(x)-1
 
-static regex begPat("<.");
-static regex xmlPatEnd("[?][>]( |\r|\n)*");
-static regex commentPatEnd("-->( |\r|\n)*");
-static regex stringPatEnd("</string>( |\r|\n)*");
-static regex stringPat("<string.*name=.([^'\"]+).[^>]*>(.|\r|\n)*</string>( |\r|\n)*");
-static regex anyPat("<([a-z]+).*name=.([^'\"]+).[^>]*>(.|\r|\n)*</([a-z]+)>");
-static regex eoxPat("<[^<]+>( |\r|\n)*");
-static regex eolPat("( |\r|\n)*");
+// Minimum buffer length per thread when parsing a single file in chunks.
+static const size_t PARSE_CHUNK_MIN = 1 << 20;
+
+// Statement endings, searched without regex so scanning is linear, uses constant stack
+// and nothing is compiled at startup.
+static const char XML_END[] = "?>";
+static const char COMMENT_END[] = "-->";
+static const char STRING_END[] = "</string>";
+static const char ITEM_END[] = "</item>";
+static const char* const TAG_END = nullptr;   // any <tag>
+
+// Extra keys no master holds, keys a master holds share its data key.
+static StringPool keyPool;
 
 
 //-------------------------------------------------------------------------------------------------
-const char* XmlBuffer::getNext(const std::regex& xmlPatBeg) const {
-    std::match_results<const char*> match;
+// Find next '<' followed by a character other than a line break, same as regex "<.".
+const char* XmlBuffer::getNext(size_t& pos, size_t end) const {
     const char* begPtr = (const char*)data() + pos;
-    const char* endPtr = (const char*)data() + size();
-
-    // std::string test = std::string(begPtr, endPtr);
+    const char* endPtr = (const char*)data() + end;
+    const char* nextPtr = begPtr;
 
-    const char* nextPtr = nullptr;
-    size_t length = 0;
-    if (std::regex_search(begPtr, endPtr, match, xmlPatBeg, rxFlags)) {
-        length = match.position();
-        const_cast<XmlBuffer*> (this)->pos += length;
-        nextPtr = begPtr + length;
-        length += match.length();
+    while ((nextPtr = (const char*)memchr(nextPtr, '<', endPtr - nextPtr)) != nullptr) {
+        if (nextPtr + 1 < endPtr && nextPtr[1] != '\n' && nextPtr[1] != '\r') {
+            pos += nextPtr - begPtr;
+            return nextPtr;
+        }
+        nextPtr++;
     }
 
-    return (length > 0) ? nextPtr : nullptr;
+    return nullptr;
 }
 
 //-------------------------------------------------------------------------------------------------
-bool XmlBuffer::getStatement(const std::regex& xmlPatEnd, std::string& outStatement) const {
-    std::match_results<const char*> match;
+// Skip white space ( |\r|\n)* trailing a statement.
+static const char* skipWhite(const char* ptr, const char* endPtr) {
+    while (ptr < endPtr && (*ptr == ' ' || *ptr == '\r' || *ptr == '\n'))
+        ptr++;
+    return ptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Return pointer past first tail found in [begPtr, endPtr) or nullptr.
+static const char* findTail(const char* begPtr, const char* endPtr, const char* tail) {
+    size_t tailLen = strlen(tail);
+    const char* tailPtr = std::search(begPtr, endPtr, tail, tail + tailLen);
+    return (tailPtr != endPtr) ? tailPtr + tailLen : nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Return pointer past first <[^<]+> found in [begPtr, endPtr) or nullptr.
+// Each span between two '<' is walked once forward and once backward.
+static const char* findTagEnd(const char* begPtr, const char* endPtr) {
+    const char* tagPtr = begPtr;
+    while ((tagPtr = (const char*)memchr(tagPtr, '<', endPtr - tagPtr)) != nullptr) {
+        const char* nextPtr = (const char*)memchr(tagPtr + 1, '<', endPtr - tagPtr - 1);
+        if (nextPtr == nullptr)
+            nextPtr = endPtr;
+        for (const char* gtPtr = nextPtr - 1; gtPtr >= tagPtr + 2; gtPtr--) {
+            if (*gtPtr == '>')
+                return gtPtr + 1;
+        }
+        tagPtr = nextPtr;
+    }
+    return nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Advance pos past statement ending with tail (or end of tag) and its trailing white space.
+// A tail missing from missFrom to end is missing from any later pos, the search is skipped.
+bool XmlBuffer::getStatement(const char* tail, size_t& pos, size_t end, size_t* missFrom) const {
+    if (missFrom != nullptr && pos >= *missFrom)
+        return false;
+
     const char* begPtr = (const char*)data() + pos;
-    const char* endPtr = (const char*)data() + size();
+    const char* endPtr = (const char*)data() + end;
 
-    if (std::regex_search(begPtr, endPtr, match, xmlPatEnd, rxFlags)) {
-        size_t length = match.position() + match.length();
-        outStatement = std::string(begPtr, begPtr + length);
-        const_cast<XmlBuffer*> (this)->pos += length;
+    const char* tailPtr = (tail != TAG_END) ? findTail(begPtr, endPtr, tail) : findTagEnd(begPtr, endPtr);
+    if (tailPtr != nullptr) {
+        tailPtr = skipWhite(tailPtr, endPtr);
+        pos += tailPtr - begPtr;
         return true;
     }
 
+    if (missFrom != nullptr)
+        *missFrom = pos;
     return false;
 }
 
+//-------------------------------------------------------------------------------------------------
+// Tag statement ends in />, trailing white space ignored.
+static bool isSelfClosing(const char* begPtr, const char* endPtr) {
+    while (endPtr != begPtr && isspace((unsigned char)endPtr[-1]))
+        endPtr--;
+    return endPtr - begPtr >= 2 && endPtr[-1] == '>' && endPtr[-2] == '/';
+}
+
+//-------------------------------------------------------------------------------------------------
+static bool isCommentEnd(const char* ptr, const char* endPtr) {
+    return endPtr - ptr >= (ptrdiff_t)sizeStr(COMMENT_END) && strncmp(ptr, COMMENT_END, sizeStr(COMMENT_END)) == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Parse <!-- BEGIN NAMESPACE name --> or <!-- END NAMESPACE name -->,
+// return 1 for begin, -1 for end and 0 for any other comment.
+static int getNamespaceMark(const char* begPtr, const char* endPtr, string& name) {
+    static const char BEGIN[] = "BEGIN NAMESPACE ";
+    static const char END[] = "END NAMESPACE ";
+    const char* ptr = begPtr + sizeStr("<!--");
+    while (ptr < endPtr && isspace((unsigned char)*ptr))
+        ptr++;
+
+    int mark = 0;
+    if (endPtr - ptr > (ptrdiff_t)sizeStr(BEGIN) && strncmp(ptr, BEGIN, sizeStr(BEGIN)) == 0) {
+        mark = 1;
+        ptr += sizeStr(BEGIN);
+    } else if (endPtr - ptr > (ptrdiff_t)sizeStr(END) && strncmp(ptr, END, sizeStr(END)) == 0) {
+        mark = -1;
+        ptr += sizeStr(END);
+    } else {
+        return 0;
+    }
+
+    // a name may hold '-', as my-feature, it ends at white space or the comment end
+    const char* nameEnd = ptr;
+    while (nameEnd < endPtr && ! isspace((unsigned char)*nameEnd) && ! isCommentEnd(nameEnd, endPtr))
+        nameEnd++;
+    if (nameEnd == ptr)
+        return 0;
+    name.assign(ptr, nameEnd);
+    return mark;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Advance pos past the END NAMESPACE comment of name and its trailing white space.
+bool XmlBuffer::skipNamespace(const string& name, size_t& pos, size_t end) const {
+    const string endMark = "END NAMESPACE " + name;
+    const char* begPtr = (const char*)data() + pos;
+    const char* endPtr = (const char*)data() + end;
+    const char* ptr = begPtr;
+
+    while ((ptr = findTail(ptr, endPtr, endMark.c_str())) != nullptr) {
+        if (ptr < endPtr && (isspace((unsigned char)*ptr) || isCommentEnd(ptr, endPtr))) {
+            const char* tailPtr = findTail(ptr, endPtr, COMMENT_END);
+            if (tailPtr == nullptr)
+                return false;
+            pos += skipWhite(tailPtr, endPtr) - begPtr;
+            return true;
+        }
+    }
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+bool XmlNamespaceFilter::selected(const string& name) const {
+    if (name.empty())
+        return include.empty();
+    bool found = include.empty();
+    for (const std::regex& pattern : include)
+        found = found || std::regex_match(name, pattern);
+    for (const std::regex& pattern : exclude)
+        found = found && ! std::regex_match(name, pattern);
+    return found;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Return true if ptr starts with tag name followed by white space, '>' or '/'.
+static bool isTag(const char* ptr, const char* name) {
+    size_t nameLen = strlen(name);
+    return strncmp(ptr, name, nameLen) == 0 && strchr(" \t\r\n>/", ptr[nameLen]) != nullptr
+        && ptr[nameLen] != '\0';
+}
+
+//-------------------------------------------------------------------------------------------------
+// Extract key from <string ... name="key" ...>, using the last attr (name=) in the opening
+// tag which is followed by a quoted value. Single forward pass over the tag.
+static bool getStringKey(const char* begPtr, const char* endPtr, string& key, const char* attr = "name=") {
+    static const char QUOTES[] = "'\"";
+    size_t attrLen = strlen(attr);
+    const char* tagEnd = std::find(begPtr, endPtr, '>');
+    const char* quotePtr = begPtr;
+    const char* keyBeg = nullptr;
+    const char* keyEnd = nullptr;
+
+    for (const char* namePtr = std::search(begPtr, tagEnd, attr, attr + attrLen);
+            namePtr != tagEnd;
+            namePtr = std::search(namePtr + 1, tagEnd, attr, attr + attrLen)) {
+        const char* valuePtr = std::min(namePtr + attrLen + 1, tagEnd);
+        if (quotePtr < valuePtr)
+            quotePtr = std::find_first_of(valuePtr, endPtr, QUOTES, QUOTES + sizeStr(QUOTES));
+        if (quotePtr > valuePtr && quotePtr < tagEnd) {
+            keyBeg = valuePtr;
+            keyEnd = quotePtr;
+        }
+    }
+
+    if (keyBeg == nullptr)
+        return false;
+
+    key.clear();
+    for (const char* ptr = keyBeg; ptr < keyEnd; ptr++) {
+        if (*ptr != '\n')
+            key += *ptr;
+    }
+    return true;
+}
+
 #define META_PREFIX  "_#"
 static char META_FMT[] = META_PREFIX "%d";
 
@@ -151,183 +310,878 @@ static void nextKey(unsigned num, string& numStr) {
 
 // -------------------------------------------------------------------------------------------------
 static string clean(const string& str) {
-    // string out = str;
-    // out.erase(remove(out.begin(), out.end(), '\n'), out.cend());
     string out(str.length(), '\0');
-    int oIdx = 0;
-    for (int i = 0; i < str.length(); i++) {
-        if (str[i] != '\n') {
-            out[oIdx++] = str[i];
-        }
-    }
-    out.resize(oIdx);
+    out.resize(TextKernel::stripNewlines(&out[0], str.data(), str.length()));
     return out;
 }
 
 // -------------------------------------------------------------------------------------------------
-static void checkDuplicate(ostream& err, const XmlData& data, const string& key,
-    const string& value, const string& filePath) {
-    if (data.find(key) != data.end() && data.at(key) != value) {
-        err << "Warning - duplicate: " << key << " in " << filePath << std::endl;
-        err << " Old=" << data.at(key) << std::endl;
-        err << " New=" << value << std::endl;
+static uint64_t hashIgnoreWhite(const string& str) {
+    return TextKernel::hashIgnoreWhite(str.data(), str.length());
+}
+
+// -------------------------------------------------------------------------------------------------
+static bool sameValue(const XmlValue& value1, const XmlValue& value2) {
+    return value1.hash == value2.hash && value1.cleared == value2.cleared && value1.statement == value2.statement;
+}
+
+// -------------------------------------------------------------------------------------------------
+static void checkDuplicate(Diagnostics& diag, const XmlData& data, const string& key,
+    const XmlValue& value, const string& filePath) {
+    XmlData::const_iterator iter = data.find(key);
+    if (iter != data.end() && ! sameValue(iter->second, value) && diag.accept(DIAG_DUPLICATE)) {
+        diag.write(DIAG_DUPLICATE, filePath, key, "Warning - duplicate: " + key + " in " + filePath
+            + "\n Old=" + iter->second.statement.str() + "\n New=" + value.statement.str());
     }
 }
 
 // -------------------------------------------------------------------------------------------------
 static bool equalIgnoreWhite(const string& str1, const string& str2) {
+    return TextKernel::equalIgnoreWhite(str1.data(), str1.length(), str2.data(), str2.length());
+}
+
+// -------------------------------------------------------------------------------------------------
+// Line breaks in front of pos, counted on from the last pos of the cursor.
+unsigned int XmlBuffer::lineAt(size_t pos, LineCursor& cursor) const {
+    if (pos < cursor.pos)
+        cursor = LineCursor();
+    cursor.line += (unsigned) TextKernel::countNewlines(data() + cursor.pos, pos - cursor.pos);
+    cursor.pos = pos;
+    return cursor.line;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Materialize value of a lazily scanned item from its buffer span.
+const XmlValue& XmlBuffer::getValue(XmlItem& item) const {
+    if (item.lazy) {
+        item.value.statement = string(item.beg, item.end);
+        item.value.hash = hashIgnoreWhite(item.value.statement);
+        if (intern)
+            item.value.statement.intern();
+        item.lazy = false;
+    }
+    return item.value;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Element text of a statement, as "Radar" of <string name="word2">Radar</string>.
+static void getText(const string& statement, const char*& beg, const char*& end) {
+    beg = statement.data();
+    end = beg + statement.length();
+    while (beg != end && isspace((unsigned char)*beg)) beg++;
+    while (end != beg && isspace((unsigned char)end[-1])) end--;
+    if (beg == end || *beg != '<')
+        return;
+    const char* open = (const char*)memchr(beg, '>', end - beg);
+    if (open == nullptr)
+        return;
+    if (open[-1] == '/') {
+        beg = end;          // <string name="empty"/>
+        return;
+    }
+    const char* close = end;
+    while (close != open && *close != '<') close--;
+    if (close == open)
+        return;
+    beg = open + 1;
+    end = close;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Element text between an open and a close tag, false for a self closing or other statement.
+static bool elementText(const string& statement, const char*& beg, const char*& end) {
+    getText(statement, beg, end);
+    const char* stmtBeg = statement.data();
+    const char* stmtEnd = stmtBeg + statement.length();
+    return beg != stmtBeg && beg[-1] == '>' && end != stmtEnd && *end == '<';
+}
 
-    const char* p1 = str1.c_str();
-    const char* p2 = str2.c_str();
-    while (*p1) {
-        while (isspace(*p1)) p1++;  // space= ' ', '\t', '\n', '\v', '\f', '\r'
-        while (isspace(*p2)) p2++;
-        if (*p1 != *p2) return false;
-        if (*p1 == '\0') break;
-        p1++;
-        p2++;
+// -------------------------------------------------------------------------------------------------
+// Element text of an xml statement with entities and Android resource escapes decoded.
+static void xmlText(const string& statement, string& text) {
+    const char* beg;
+    const char* end;
+    getText(statement, beg, end);
+    text.clear();
+    while (beg < end) {
+        char chr = *beg++;
+        if (chr == '&') {
+            const char* semi = (const char*)memchr(beg, ';', std::min<size_t>(end - beg, 10));
+            string entity = (semi != nullptr) ? string(beg, semi) : "";
+            if (entity == "lt") text += '<';
+            else if (entity == "gt") text += '>';
+            else if (entity == "amp") text += '&';
+            else if (entity == "quot") text += '"';
+            else if (entity == "apos") text += '\'';
+            else if (entity.length() > 1 && entity[0] == '#') {
+                unsigned long code = (entity[1] == 'x')
+                    ? strtoul(entity.c_str() + 2, nullptr, 16) : strtoul(entity.c_str() + 1, nullptr, 10);
+                Json::appendUtf8(text, (unsigned)code);
+            } else {
+                text += '&';
+                continue;
+            }
+            beg = semi + 1;
+        } else if (chr == '\\' && beg < end) {
+            chr = *beg++;
+            text += (chr == 'n') ? '\n' : (chr == 't') ? '\t' : chr;
+        } else {
+            text += chr;
+        }
     }
-    return (*p2 == '\0');
 }
 
 // -------------------------------------------------------------------------------------------------
-unsigned int XmlBuffer::lineAt(size_t pos) const {
-    return (unsigned) std::count(data(), data() + pos, '\n');
+// Statement of an xml master entry holding text, the reverse of xmlText(). The master's own
+// open tag, attributes and trailing text are kept, only its element text is replaced.
+// A self closing master gets a statement built from the key:
+//   key           <string name="key">text</string>
+//   key[one]      <item quantity="one">text</item>
+//   key[0]        <item>text</item>
+static void xmlStatement(const string& key, const string& text, const string& master, string& statement) {
+    string escaped;
+    for (char chr : text) {
+        switch (chr) {
+        case '&':  escaped += "&amp;"; break;
+        case '<':  escaped += "&lt;"; break;
+        case '>':  escaped += "&gt;"; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\'': escaped += "\\'"; break;
+        case '"':  escaped += "\\\""; break;
+        case '\n': escaped += "\\n"; break;
+        case '\t': escaped += "\\t"; break;
+        default:   escaped += chr; break;
+        }
+    }
+
+    const char* beg;
+    const char* end;
+    const char* masterBeg = master.data();
+    const char* masterEnd = masterBeg + master.length();
+    if (elementText(master, beg, end)) {
+        statement.assign(masterBeg, beg);
+        statement += escaped;
+        statement.append(end, masterEnd);
+        return;
+    }
+
+    size_t bracket = key.find('[');
+    bool item = bracket != string::npos && key.back() == ']';
+    if (item) {
+        string index = key.substr(bracket + 1, key.length() - bracket - 2);
+        if (! index.empty() && isdigit((unsigned char)index[0]))
+            statement = "<item>";
+        else
+            statement = "<item quantity=\"" + index + "\">";
+    } else {
+        statement = "<string name=\"" + key + "\">";
+    }
+    statement += escaped;
+    statement += item ? "</item>" : "</string>";
+    while (masterEnd != masterBeg && isspace((unsigned char)masterEnd[-1]))
+        masterEnd--;
+    statement.append(masterEnd, masterBeg + master.length());
+}
+
+// -------------------------------------------------------------------------------------------------
+// Length of the json value a data statement starts with, the rest is the text up to the next value.
+static size_t jsonValueLength(const string& statement) {
+    return Json::valueLength(statement.data(), statement.data() + statement.length());
 }
 
 // -------------------------------------------------------------------------------------------------
-bool XmlBuffer::parse(ostream& err, string filePath, bool master) {
+// Decoded text of a data value, json string literal or xml statement.
+static void valueText(bool json, const string& statement, string& text) {
+    if (json) {
+        text.clear();
+        if (! statement.empty() && statement[0] == '"')
+            Json::unescape(statement.data(), statement.data() + jsonValueLength(statement), text);
+    } else {
+        xmlText(statement, text);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Item value for a master of either format. A json master keeps its text after the value,
+// an xml master its tags and text around the element text.
+const XmlValue& XmlBuffer::masterValue(XmlItem& item, const XmlValue& curValue, bool json,
+        XmlValue& converted) const {
+    const string& statement = getValue(item).statement;
+    if (! json && ! item.json)
+        return item.value;
+
+    string result;
+    if (json) {
+        if (item.json) {
+            result.assign(statement, 0, jsonValueLength(statement));
+        } else {
+            string text;
+            xmlText(statement, text);
+            Json::escape(text, result);
+        }
+        const string& tail = curValue.statement;
+        result.append(tail, jsonValueLength(tail), string::npos);
+    } else {
+        string text;
+        valueText(true, statement, text);
+        xmlStatement(item.key, text, curValue.statement, result);
+    }
+    converted.hash = hashIgnoreWhite(result);
+    converted.statement = std::move(result);
+    return converted;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Scan buffer from pos up to end into items, return false if an error was reported.
+// Lazy items only record key and span, the value is copied when first needed.
+// The <item>s of <plurals> and <string-array> are data keyed name[quantity] and name[index].
+// Namespaces not selected by nsFilter are skipped to their END marker as one meta statement,
+// data outside the selection or with a key keyFilter rejects is kept as meta.
+bool XmlBuffer::scan(size_t& pos, size_t end, XmlItems& items, bool lazy) const {
 
-    smatch match;
     vector<string> blockKeys;
-    unsigned row = 0;
     string key;
-    string statement;
-    size_t lastPos = 0;
+    string arrayKey;        // name of the open <plurals> or <string-array>
+    bool isPlurals = false;
+    unsigned arrayIdx = 0;
+    vector<string> nsNames;     // open sections, innermost last
+    bool nsSelected = (nsFilter == nullptr || nsFilter->selected(""));
+    size_t stmtBeg = 0;
+    size_t stmtEnd = 0;
+    size_t lastPos = pos;
     const char* nextPtr;
-    pos = 0;
-
-    static FileData noData;
-    FileData& fileData = master ? filesData[filePath] : noData;
+    bool isClean = true;
+    LineCursor lines;
+    size_t xmlMiss = end;       // tails known missing from these offsets on, so
+    size_t commentMiss = end;   // each unterminated statement does not search to end
+    size_t stringMiss = end;
+    size_t itemMiss = end;
 
-    while ((nextPtr = getNext(begPat)) != nullptr) {
+    while ((nextPtr = getNext(pos, end)) != nullptr) {
         if (pos > lastPos + 1) {
-            nextKey(row++, key);
-            if (master) {
-                fileData.rows.push_back(key);
-                statement = string(data() + lastPos, data() + pos);
-                checkDuplicate(err, fileData.meta, key, statement, filePath);
-                fileData.meta[key] = statement;
-            }
+            items.push_back(XmlItem());
+            items.back().beg = data() + lastPos;
+            items.back().end = data() + pos;
+            items.back().lazy = true;
+            if (! lazy)
+                getValue(items.back());
         }
 
+        size_t begPos = pos;
         bool okay = false;
         bool isMeta = true;
+        unsigned skip = 0;
+        string error;
+        string nsMark;
+        bool nsBegin = false;
+        bool nsEnd = false;
 
         switch (nextPtr[1]) {
         case '?':  // xml header <?xml .... ?>
-            okay = getStatement(xmlPatEnd, statement);
-            nextKey(row++, key);
+            okay = getStatement(XML_END, pos, end, &xmlMiss);
+            skip = okay ? 0 : 1;
             break;
         case '!':  // comment <!-- xxxx -->
-            okay = getStatement(commentPatEnd, statement);
-            nextKey(row++, key);
+            okay = getStatement(COMMENT_END, pos, end, &commentMiss);
+            skip = okay ? 0 : 1;
+            if (okay) {
+                int mark = getNamespaceMark(data() + begPos, data() + pos, nsMark);
+                if (mark > 0) {
+                    nsBegin = true;
+                    if (nsFilter != nullptr && ! nsFilter->selected(nsMark) && skipNamespace(nsMark, pos, end)) {
+                        nsEnd = true;
+                    } else {
+                        nsNames.push_back(nsMark);
+                        nsSelected = (nsFilter == nullptr || nsFilter->selected(nsMark));
+                    }
+                } else if (mark < 0) {
+                    nsEnd = true;
+                    auto open = std::find(nsNames.rbegin(), nsNames.rend(), nsMark);
+                    if (open != nsNames.rend())
+                        nsNames.erase(std::next(open).base());
+                    nsSelected = (nsFilter == nullptr || nsFilter->selected(nsNames.empty() ? "" : nsNames.back()));
+                }
+            }
             break;
         case '/':   // end of a block, </resources>
+            if (! arrayKey.empty() && isTag(nextPtr, isPlurals ? "</plurals" : "</string-array")) {
+                okay = getStatement(TAG_END, pos, end);
+                skip = okay ? 0 : 1;
+                arrayKey.clear();
+                break;
+            }
             key = blockKeys.empty() ? "" : blockKeys.back();
-            if (strncmp(key.c_str() + 1, nextPtr + 2, key.length() - 1) == 0) {
-                okay = getStatement(eoxPat, statement);
-                nextKey(row++, key);
+            if (! blockKeys.empty() && strncmp(key.c_str() + 1, nextPtr + 2, key.length() - 1) == 0) {
+                okay = getStatement(TAG_END, pos, end);
+                skip = okay ? 0 : 1;
                 blockKeys.pop_back();
             }
             break;
         case 's':
             // <string name="key" opt="flags">String Value</string>
             if (strncmp("<string ", nextPtr, 8) == 0) {
-                okay = getStatement(stringPatEnd, statement);
-                string test = clean(statement);
-                okay &= std::regex_search(test, match, stringPat, rxFlags);
+                stmtBeg = begPos;
+                if (getStatement(STRING_END, pos, end, &stringMiss)) {
+                    stmtEnd = pos;
+                    okay = getStringKey(data() + stmtBeg, data() + stmtEnd, key);
+                } else {
+                    // no </string>, the error shows the statement up to the next tag
+                    const char* tagPtr = (const char*)memchr(nextPtr + 1, '<', data() + end - nextPtr - 1);
+                    stmtEnd = (tagPtr != nullptr ? tagPtr : data() + end) - data();
+                }
                 if (okay) {
-                    // match[0]=whole string; match[1]=first capture group.
-                    if (match.size() >= 2) {
-                        key = match[1].str();
-                        // err << "in=" << test << " key=" << key << std::endl;
-                        isMeta = false;
-                    }
+                    isMeta = false;
                 } else {
                     okay = false;
-                    err << "Error - Line: " << lineAt(pos) << " Unknown: " << clean(statement) << ", In:" << filePath << std::endl;
+                    error = "Error - Line: " + to_string(lineAt(pos, lines)) + " Unknown: "
+                        + clean(string(data() + stmtBeg, data() + stmtEnd)) + ", In:";
                 }
+                break;
             }
-            break;
-        }
-
-        if (okay) {
-            if (master) {
-                fileData.rows.push_back(key);
-                if (isMeta) {
-                    checkDuplicate(err, fileData.meta, key, statement, filePath);
-                    fileData.meta[key] = statement;
+            // fall through
+        case 'p':
+            // <plurals name="key"> or <string-array name="key">, opens keyed <item>s
+            if (arrayKey.empty() && (isTag(nextPtr, "<plurals") || isTag(nextPtr, "<string-array"))) {
+                okay = getStatement(TAG_END, pos, end)
+                    && getStringKey(data() + begPos, data() + pos, arrayKey);
+                if (okay && isSelfClosing(data() + begPos, data() + pos)) {
+                    arrayKey.clear();   // <string-array name="empty"/> holds no items
+                } else if (okay) {
+                    isPlurals = (nextPtr[1] == 'p');
+                    arrayIdx = 0;
                 } else {
-                    checkDuplicate(err, fileData.data, key, statement, filePath);
-                    fileData.data[key] = statement;
-                    // err << "Added [" << key << "]=" << statement << std::endl;
+                    pos = begPos;
+                    arrayKey.clear();
                 }
-            } else if (! isMeta) {
-                if (! update(key, statement))
-                    err << "Warning - extra: " << clean(statement) << ", In:" << filePath << std::endl;
             }
-        } else {
-            okay = getStatement(eoxPat, statement);
-            if (okay) {
-                blockKeys.push_back(statement);
-                if (master) {
-                    nextKey(row++, key);
-                    fileData.rows.push_back(key);
-                    checkDuplicate(err, fileData.meta, key, statement, filePath);
-                    fileData.meta[key] = statement;
+            break;
+        case 'i':
+            // <item quantity="one">Value</item>
+            if (! arrayKey.empty() && isTag(nextPtr, "<item")) {
+                okay = getStatement(ITEM_END, pos, end, &itemMiss);
+                if (okay) {
+                    string quantity;
+                    if (isPlurals && getStringKey(data() + begPos, data() + pos, quantity, "quantity="))
+                        key = arrayKey + "[" + quantity + "]";
+                    else
+                        key = arrayKey + "[" + to_string(arrayIdx) + "]";
+                    arrayIdx++;
+                    isMeta = false;
                 }
+            }
+            break;
+        }
+
+        if (! okay) {
+            begPos = pos;
+            okay = getStatement(TAG_END, pos, end);
+            if (okay) {
+                blockKeys.push_back(string(data() + begPos, data() + pos));
             } else {
-                err << "Error - Line: " << lineAt(pos) << " Unknown: " << string(nextPtr, nextPtr + 10) << ", In:" << filePath << std::endl;
+                if (! error.empty()) {
+                    items.push_back(XmlItem());     // the <string error, reported before the abort
+                    items.back().error = error;
+                    items.back().abort = true;
+                }
+                items.push_back(XmlItem());
+                items.back().error = "Error - Line: " + to_string(lineAt(pos, lines)) + " Unknown: " + string(nextPtr, nextPtr + 10) + ", In:";
+                items.back().abort = true;
                 return false;
             }
         }
+        stmtBeg = begPos;
+        stmtEnd = pos;
+        if (! isMeta && (! nsSelected || (keyFilter != nullptr && ! keyFilter->selected(key))))
+            isMeta = true;      // not merged, masters keep it as is
+
+        items.push_back(XmlItem());
+        XmlItem& item = items.back();
+        item.beg = data() + stmtBeg;
+        item.end = data() + stmtEnd;
+        item.lazy = true;
+        if (! lazy)
+            getValue(item);
+        item.error = error;
+        item.skip = skip;
+        item.isMeta = isMeta;
+        item.nsMark = nsMark;
+        item.nsBegin = nsBegin;
+        item.nsEnd = nsEnd;
+        if (! isMeta)
+            item.key = key;
+        isClean &= error.empty();
 
         lastPos = pos;
     }
 
+    return isClean;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Locate buffer offsets directly in front of a '<' which follows </string> and its
+// white space, where the serial scan is guaranteed to be between two statements.
+void XmlBuffer::getChunkCuts(vector<size_t>& cuts, size_t chunkLen) const {
+    const char* begPtr = data();
+    const char* endPtr = data() + size();
+    const char* cutPtr = begPtr + chunkLen;
+    const char* ptr = begPtr;
+
+    while (ptr < endPtr && (ptr = (const char*)memchr(ptr, '<', endPtr - ptr)) != nullptr) {
+        bool isString = false;
+        if (ptr[1] == '!') {
+            ptr = findTail(ptr, endPtr, COMMENT_END);
+        } else if (ptr[1] == '?') {
+            ptr = findTail(ptr, endPtr, XML_END);
+        } else if (strncmp("<string ", ptr, 8) == 0) {
+            ptr = findTail(ptr, endPtr, STRING_END);
+            isString = true;
+        } else {
+            ptr = findTagEnd(ptr, endPtr);
+        }
+        if (ptr == nullptr)
+            break;
+
+        ptr = skipWhite(ptr, endPtr);
+        if (isString && ptr >= cutPtr && ptr < endPtr && *ptr == '<') {
+            cuts.push_back(ptr - begPtr);
+            cutPtr = ptr + chunkLen;
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Scan large buffer in chunks on parallel threads, falls back to a serial scan
+// if any chunk did not end cleanly on its boundary.
+bool XmlBuffer::scanChunks(XmlItems& items, bool lazy) const {
+    size_t pos = 0;
+    if (nsFilter != nullptr) {
+        // a chunk does not know the namespace open at its start
+        return scan(pos, size(), items, lazy);
+    }
+
+    vector<size_t> cuts;
+    getChunkCuts(cuts, std::max(size() / parseThreads, PARSE_CHUNK_MIN));
+    if (cuts.empty()) {
+        return scan(pos, size(), items, lazy);
+    }
+
+    cuts.insert(cuts.begin(), 0);
+    cuts.push_back(size());
+    size_t chunkCnt = cuts.size() - 1;
+    vector<XmlItems> chunkItems(chunkCnt);
+    vector<char> chunkOk(chunkCnt, false);
+    vector<thread> threads;
+
+    for (size_t idx = 0; idx < chunkCnt; idx++) {
+        threads.push_back(thread([&, idx]() {
+            PerfCounters::Scope scope(perf, PerfCounters::PARSE);
+            size_t chunkPos = cuts[idx];
+            chunkOk[idx] = scan(chunkPos, cuts[idx + 1], chunkItems[idx], lazy)
+                && (idx + 1 == chunkCnt || chunkPos == cuts[idx + 1]);
+        }));
+    }
+    for (thread& worker : threads) {
+        worker.join();
+    }
+
+    if (std::find(chunkOk.begin(), chunkOk.end(), false) != chunkOk.end()) {
+        return scan(pos, size(), items, lazy);
+    }
+
+    for (XmlItems& chunk : chunkItems) {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(items));
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Close the innermost open range of namespace name after the current last row.
+static void endNamespace(FileData& fileData, const string& name) {
+    for (auto range = fileData.namespaces.rbegin(); range != fileData.namespaces.rend(); range++) {
+        if (range->name == name && range->endRow == range->begRow) {
+            range->endRow = fileData.rows.size();
+            break;
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Store (master) or update from (child) the scanned items.
+bool XmlBuffer::apply(Diagnostics& diag, const string& filePath, bool master, XmlItems& items) {
+    unsigned row = 0;
+    string key;
+
+    static FileData noData;
+    FileData& fileData = master ? filesData[filePath] : noData;
+    if (master && shard != nullptr)
+        fileData.foreign = ! shard->owns(filePath);
+
+    for (XmlItem& item : items) {
+        if (! item.error.empty()) {
+            diag.report(DIAG_ERROR, filePath, item.key, item.error + filePath);
+        }
+        if (item.abort) {
+            if (&item != &items.back())
+                continue;   // more errors before the statement which stopped the scan
+            return false;
+        }
+
+        row += item.skip;
+        if (item.isMeta) {
+            nextKey(row++, key);
+            if (master) {
+                if (item.nsBegin)
+                    fileData.namespaces.push_back(XmlRange{ item.nsMark, fileData.rows.size(), fileData.rows.size() });
+                fileData.rows.push_back(key);
+                if (item.nsEnd)
+                    endNamespace(fileData, item.nsMark);
+                checkDuplicate(diag, fileData.meta, key, item.value, filePath);
+                fileData.meta[key] = std::move(item.value);
+            }
+        } else if (master) {
+            fileData.rows.push_back(item.key);
+            fileData.json = item.json;
+            checkDuplicate(diag, fileData.data, item.key, item.value, filePath);
+            fileData.data[item.key] = std::move(item.value);
+            // err << "Added [" << item.key << "]=" << item.value.statement << std::endl;
+        } else {
+            if (! item.applied)
+                item.updated = update(item, nullptr, 0);
+            for (const string& dupFile : item.duplicates) {
+                diag.report(DIAG_DUPLICATE, dupFile, item.key, "Warning - duplicate: " + item.key + ", file=" + dupFile);
+            }
+            if (! item.updated && diag.accept(DIAG_EXTRA)) {
+                const string& statement = getValue(item).statement;
+                diag.write(DIAG_EXTRA, filePath, item.key, "Warning - extra: "
+                    + clean(item.json ? statement.substr(0, jsonValueLength(statement)) : statement) + ", In:" + filePath);
+            }
+        }
+    }
+
     return filesData.size() > 0;
 }
 
 // -------------------------------------------------------------------------------------------------
+bool XmlBuffer::parse(Diagnostics& diag, string filePath, bool master) {
+    XmlItems items;
+    size_t pos = 0;
+    json = Json::isJsonPath(filePath);
+    {
+        PerfCounters::Scope scope(perf, PerfCounters::PARSE, size());
+        if (json) {
+            scanJson(pos, size(), items, ! master);
+        } else if (parseThreads > 1 && size() >= PARSE_CHUNK_MIN * 2) {
+            scanChunks(items, ! master);
+        } else {
+            scan(pos, size(), items, ! master);
+        }
+    }
+    PerfCounters::Scope scope(perf, PerfCounters::UPDATE);
+    return apply(diag, filePath, master, items);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Scan buffer of a file read by the pipeline, child values stay lazy and their
+// key hashes are kept to split the items in update shards.
+void XmlBuffer::scanFile(XmlItems& items, bool master) const {
+    PerfCounters::Scope scope(perf, PerfCounters::PARSE, size());
+    size_t pos = 0;
+    if (json) {
+        scanJson(pos, size(), items, ! master);
+    } else if (parseThreads > 1 && size() >= PARSE_CHUNK_MIN * 2) {
+        scanChunks(items, ! master);
+    } else {
+        scan(pos, size(), items, ! master);
+    }
+    if (! master) {
+        for (XmlItem& item : items) {
+            if (! item.isMeta)
+                item.keyHash = std::hash<string>()(item.key);
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Report and apply remaining items of a file scanned by scanFile().
+bool XmlBuffer::applyFile(Diagnostics& diag, XmlFile& file) {
+    PerfCounters::Scope scope(perf, PerfCounters::UPDATE);
+    return apply(diag, file.filePath, file.master, file.items);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Update masters from the data items of scanned children. Keys are split in shards,
+// each updated on its own thread in child order, so the masters end the same as when
+// the children are applied one by one. Diagnostics stay on the items for applyFile().
+void XmlBuffer::updateChildren(vector<XmlFile>& children) {
+    PerfCounters::Scope scope(perf, PerfCounters::UPDATE);
+    size_t shardCnt = std::max(parseThreads, 1u);
+    vector<XmlShard> shards(shardCnt);
+    vector<thread> threads;
+
+    for (size_t shardIdx = 0; shardIdx < shardCnt; shardIdx++) {
+        threads.push_back(thread([&, shardIdx]() {
+            PerfCounters::Scope scope(perf, PerfCounters::UPDATE);
+            XmlShard& shard = shards[shardIdx];
+            shard.updates.resize(fileList.size());
+            shard.extra.resize(fileList.size());
+            shard.newUpdates.resize(children.size());
+            shard.newExtras.resize(children.size());
+            for (size_t childIdx = 0; childIdx < children.size(); childIdx++) {
+                for (XmlItem& item : children[childIdx].items) {
+                    if (item.abort)
+                        break;
+                    if (! item.isMeta && item.keyHash % shardCnt == shardIdx) {
+                        item.updated = update(item, &shard, childIdx);
+                        item.applied = true;
+                    }
+                }
+            }
+        }));
+    }
+    for (thread& worker : threads) {
+        worker.join();
+    }
+
+    for (XmlShard& shard : shards) {
+        for (size_t fileIdx = 0; fileIdx < fileList.size(); fileIdx++) {
+            FileData& fileData = fileList[fileIdx]->second;
+            for (auto& update : shard.updates[fileIdx]) {
+                fileData.updates[update.first] = std::move(update.second);
+            }
+            fileData.extra.insert(shard.extra[fileIdx].begin(), shard.extra[fileIdx].end());
+        }
+        for (size_t childIdx = 0; childIdx < children.size(); childIdx++) {
+            children[childIdx].updates += shard.newUpdates[childIdx];
+            children[childIdx].extras += shard.newExtras[childIdx];
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Clear master values before children are applied.
 void XmlBuffer::clearData() {
+    static const string JSON_NO_VALUE = "null";
     for (auto& file : filesData) {
         for (auto& data : file.second.data) {
-            data.second.clear();
+            if (file.second.json) {
+                // keep the text to the next value
+                XmlValue& value = data.second;
+                string statement = value.statement;
+                statement.replace(0, jsonValueLength(statement), JSON_NO_VALUE);
+                value.hash = hashIgnoreWhite(statement);
+                value.statement = std::move(statement);
+                if (intern)
+                    value.statement.intern();
+            } else {
+                // keep the tags and trailing text, a json child only replaces the element text
+                XmlValue& value = data.second;
+                const char* beg;
+                const char* end;
+                if (elementText(value.statement, beg, end)) {
+                    string statement = value.statement;
+                    statement.erase(beg - value.statement.data(), end - beg);
+                    value.statement = std::move(statement);
+                    if (intern)
+                        value.statement.intern();
+                }
+                value.hash = 0;
+                value.cleared = true;
+            }
+        }
+    }
+    buildIndex();
+}
+
+// -------------------------------------------------------------------------------------------------
+// Index master keys, so a child key is located with a single lookup.
+void XmlBuffer::buildIndex() {
+    fileList.clear();
+    keyIndex.clear();
+    for (auto file = filesData.begin(); file != filesData.end(); file++) {
+        size_t fileIdx = fileList.size();
+        fileList.push_back(file);
+        XmlData& data = file->second.data;
+        for (auto iter = data.begin(); iter != data.end(); iter++) {
+            keyIndex[iter->first].push_back(XmlHolder{fileIdx, iter});
         }
     }
 }
 
 // -------------------------------------------------------------------------------------------------
-bool XmlBuffer::update(const string& key, const string& statement) {
+static void saveData(ostream& out, const XmlData& data) {
+    JournalIO::put(out, (uint64_t)data.size());
+    for (const auto& entry : data) {
+        JournalIO::put(out, entry.first);
+        JournalIO::put(out, entry.second.statement.str());
+        JournalIO::put(out, entry.second.hash);
+        JournalIO::put(out, (uint64_t)entry.second.cleared);
+    }
+}
+
+static bool loadData(const char*& ptr, const char* end, XmlData& data, bool intern) {
+    uint64_t count;
+    if (! JournalIO::get(ptr, end, count))
+        return false;
+    string key;
+    string statement;
+    uint64_t cleared;
+    for (uint64_t idx = 0; idx < count; idx++) {
+        XmlValue value;
+        if (! JournalIO::get(ptr, end, key) || ! JournalIO::get(ptr, end, statement)
+                || ! JournalIO::get(ptr, end, value.hash) || ! JournalIO::get(ptr, end, cleared))
+            return false;
+        value.statement = std::move(statement);
+        if (intern)
+            value.statement.intern();
+        value.cleared = cleared != 0;
+        data.emplace_hint(data.end(), key, std::move(value));
+    }
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Everything writeFilesTo and later children need, the key index is rebuilt when loaded.
+void XmlBuffer::saveState(ostream& out) const {
+    JournalIO::put(out, (uint64_t)filesData.size());
+    for (const auto& file : filesData) {
+        const FileData& fileData = file.second;
+        JournalIO::put(out, file.first);
+        JournalIO::put(out, (uint64_t)fileData.json);
+        JournalIO::put(out, (uint64_t)fileData.rows.size());
+        for (const string& row : fileData.rows) {
+            JournalIO::put(out, row);
+        }
+        saveData(out, fileData.meta);
+        saveData(out, fileData.data);
+        saveData(out, fileData.updates);
+        JournalIO::put(out, (uint64_t)fileData.extra.size());
+        for (const string* key : fileData.extra) {
+            JournalIO::put(out, *key);
+        }
+        JournalIO::put(out, (uint64_t)fileData.namespaces.size());
+        for (const XmlRange& range : fileData.namespaces) {
+            JournalIO::put(out, range.name);
+            JournalIO::put(out, (uint64_t)range.begRow);
+            JournalIO::put(out, (uint64_t)range.endRow);
+        }
+    }
+}
+
+bool XmlBuffer::loadState(const char*& ptr, const char* end) {
+    filesData.clear();
+    uint64_t fileCnt, json, count, begRow, endRow;
+    string name;
+    vector<pair<FileData*, vector<string>>> extras;    // resolved once all masters are indexed
+    bool ok = JournalIO::get(ptr, end, fileCnt);
+    for (uint64_t fileIdx = 0; ok && fileIdx < fileCnt; fileIdx++) {
+        ok = JournalIO::get(ptr, end, name) && JournalIO::get(ptr, end, json)
+            && JournalIO::get(ptr, end, count);
+        if (! ok)
+            break;
+        FileData& fileData = filesData[name];
+        fileData.json = (json != 0);
+        fileData.foreign = (shard != nullptr && ! shard->owns(name));
+        for (uint64_t idx = 0; ok && idx < count; idx++) {
+            fileData.rows.push_back(string());
+            ok = JournalIO::get(ptr, end, fileData.rows.back());
+        }
+        ok = ok && loadData(ptr, end, fileData.meta, intern) && loadData(ptr, end, fileData.data, intern)
+            && loadData(ptr, end, fileData.updates, intern) && JournalIO::get(ptr, end, count);
+        if (ok) {
+            extras.push_back(make_pair(&fileData, vector<string>()));
+            extras.back().second.resize((size_t)count);
+        }
+        for (uint64_t idx = 0; ok && idx < count; idx++) {
+            ok = JournalIO::get(ptr, end, extras.back().second[idx]);
+        }
+        ok = ok && JournalIO::get(ptr, end, count);
+        for (uint64_t idx = 0; ok && idx < count; idx++) {
+            XmlRange range;
+            ok = JournalIO::get(ptr, end, range.name) && JournalIO::get(ptr, end, begRow)
+                && JournalIO::get(ptr, end, endRow);
+            range.begRow = (size_t)begRow;
+            range.endRow = (size_t)endRow;
+            fileData.namespaces.push_back(range);
+        }
+    }
+    if (! ok)
+        filesData.clear();
+    buildIndex();
+
+    // Same key strings as update() adds: a master's key if any holds it, else the pool's.
+    for (size_t idx = 0; ok && idx < extras.size(); idx++) {
+        FileData& fileData = *extras[idx].first;
+        fileData.extra.reserve(extras[idx].second.size());
+        for (const string& key : extras[idx].second) {
+            XmlIndex::const_iterator found = keyIndex.find(key);
+            fileData.extra.insert(found != keyIndex.end() ? &found->second.front().iter->first : keyPool.intern(key));
+        }
+    }
+    return ok;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Update masters holding item key, the item value is only materialized for those.
+// Without a shard the masters are changed directly, with a shard new updates and
+// extras are collected in it and only the data values of its own keys are touched.
+bool XmlBuffer::update(XmlItem& item, XmlShard* shard, size_t childIdx) {
+    const string& key = item.key;
+    const XmlHolder* holder = nullptr;
+    const XmlHolder* holderEnd = nullptr;
+    const string* extraKey = nullptr;
+    XmlIndex::const_iterator found = keyIndex.find(key);
+    if (found != keyIndex.end()) {
+        holder = found->second.data();
+        holderEnd = holder + found->second.size();
+        extraKey = &holder->iter->first;
+    }
+
     bool updated = false;
-    for (auto& file : filesData) {
-        FileData& fileData = file.second;
-        if (fileData.data.find(key) != fileData.data.end()) {
+    XmlValue converted;     // item value for a json master or from a json child
+    for (size_t fileIdx = 0; fileIdx < fileList.size(); fileIdx++) {
+        FileData& fileData = fileList[fileIdx]->second;
+        if (holder != holderEnd && holder->fileIdx == fileIdx) {
+            XmlValue& curValue = (holder++)->iter->second;
+            if (fileData.foreign && ! updated && holder == holderEnd) {
+                updated = true;     // another shard updates it, no later master to compare
+                continue;
+            }
+            const XmlValue& value = masterValue(item, curValue, fileData.json, converted);
             if (updated) {
-                if (fileData.data.at(key) != statement) {
-                    std::cerr << "Warning - duplicate: " << key << ", file=" << file.first << endl;
+                if (! sameValue(curValue, value)) {
+                    item.duplicates.push_back(fileList[fileIdx]->first);
                 }
+            } else if (fileData.foreign) {
+                updated = true;     // value only needed to compare later masters
             } else {
-                const string& prevStatement = fileData.data.at(key);
-                if (prevStatement.empty() || ! equalIgnoreWhite(prevStatement, statement)) {
-                    fileData.updates[key] = prevStatement;
+                if (curValue.cleared || curValue.hash != value.hash
+                        || ! equalIgnoreWhite(curValue.statement, value.statement)) {
+                    if (shard == nullptr) {
+                        fileData.updates[key] = curValue;
+                    } else {
+                        XmlData& updates = shard->updates[fileIdx];
+                        if (fileData.updates.count(key) == 0 && updates.count(key) == 0)
+                            shard->newUpdates[childIdx]++;
+                        updates[key] = curValue;
+                    }
+                }
+                if (&value == &converted) {
+                    curValue = std::move(converted);
+                    if (intern)
+                        curValue.statement.intern();
+                } else {
+                    curValue = value;   // interned by getValue with -intern
                 }
-                fileData.data[key] = statement;
                 updated = true;
             }
-        } else  {
-            fileData.extra[key] = statement;
+        } else if (! fileData.foreign) {
+            if (extraKey == nullptr)
+                extraKey = keyPool.intern(key);
+            if (shard == nullptr) {
+                fileData.extra.insert(extraKey);
+            } else if (fileData.extra.count(extraKey) == 0 && shard->extra[fileIdx].insert(extraKey).second) {
+                shard->newExtras[childIdx]++;
+            }
         }
     }
     return updated;
@@ -353,62 +1207,246 @@ unsigned int XmlBuffer::getExtras() const {
     return extras;
 }
 
+// -------------------------------------------------------------------------------------------------
+// Interned: extra=5000 keys=900 saved=160000 bytes
+// Interned: values=90000 statements=20000 saved=2400000 bytes      ; with -intern
+// Saved is what a string per extra entry or value would hold beyond the shared strings.
+void XmlBuffer::reportKeys(Diagnostics& diag) const {
+    size_t extras = 0;
+    size_t bytes = 0;
+    unordered_set<const string*> keys;
+    for (const auto& file : filesData) {
+        for (const string* key : file.second.extra) {
+            extras++;
+            bytes += sizeof(string) + key->length();
+            if (keys.insert(key).second)
+                bytes -= sizeof(string) + key->length();
+        }
+    }
+    diag.report(DIAG_INFO, "", "", "Interned: extra=" + to_string(extras)
+        + " keys=" + to_string(keys.size())
+        + " saved=" + to_string(bytes) + " bytes");
+    if (! intern)
+        return;
+
+    size_t values = 0;
+    size_t valueBytes = 0;
+    unordered_set<const void*> statements;
+    auto count = [&](const XmlData& data) {
+        for (const auto& entry : data) {
+            const PooledText& statement = entry.second.statement;
+            if (statement.empty())
+                continue;
+            values++;
+            if (! statements.insert(statement.id()).second)
+                valueBytes += sizeof(string) + statement.length();
+        }
+    };
+    for (const auto& file : filesData) {
+        count(file.second.meta);
+        count(file.second.data);
+        count(file.second.updates);
+    }
+    diag.report(DIAG_INFO, "", "", "Interned: values=" + to_string(values)
+        + " statements=" + to_string(statements.size())
+        + " saved=" + to_string(valueBytes) + " bytes");
+}
+
+// -------------------------------------------------------------------------------------------------
+// Statement of a row as written, nothing for an xml master row no child set.
+static const string& rowStatement(const FileData& fileData, const string& key) {
+    static const string NO_STATEMENT;
+    if (key.compare(0, sizeStr(META_PREFIX), META_PREFIX) == 0)
+        return fileData.meta.at(key).statement.str();
+    const XmlValue& value = fileData.data.at(key);
+    return value.cleared ? NO_STATEMENT : value.statement.str();
+}
+
+// -------------------------------------------------------------------------------------------------
+// Render rows of file.
+static void renderRows(string& out, const FileData& fileData) {
+    size_t len = 0;
+    for (const string& key : fileData.rows) {
+        len += rowStatement(fileData, key).length();
+    }
+    out.reserve(len);
+    for (const string& key : fileData.rows) {
+        out += rowStatement(fileData, key);
+    }
+}
+
+// Result of writing one file, reported in filesData order.
+struct WriteResult {
+    bool toStdout = false;
+    vector<Diagnostic> log;
+    string rows;    // cout, if output is stdout
+};
+
 // -------------------------------------------------------------------------------------------------
 // Dump parsed json in json format.
-void XmlBuffer::writeFilesTo(const string& outFmt, bool verbose) const {
+// Files are rendered and written on parseThreads workers, messages are printed in order.
+void XmlBuffer::writeFilesTo(Diagnostics& diag, const string& outFmt, bool verbose, Journal* journal) const {
     if (outFmt.length() == 0) {
         return;
     }
 
-    for (const auto& file : filesData) {
-        const FileData& fileData = file.second;
+    PerfCounters::Scope scope(perf, PerfCounters::WRITE);
+    FileUtil::PathFormat pathFormat(outFmt);
+    FileUtil::DirMaker dirMaker;
+    vector<map<string, FileData>::const_iterator> files;
+    for (auto file = filesData.begin(); file != filesData.end(); file++) {
+        files.push_back(file);
+    }
+    vector<WriteResult> results(files.size());
 
-        const string& filePath = file.first;
-        const Strings& fileRow = fileData.rows;
-        const XmlData& xmlMeta = fileData.meta;
-        const XmlData& xmlData = fileData.data;
+    auto writeFile = [&](size_t idx) {
+        const string& filePath = files[idx]->first;
+        const FileData& fileData = files[idx]->second;
         const XmlData& updates = fileData.updates;
+        WriteResult& result = results[idx];
+        vector<Diagnostic>& log = result.log;
 
+        if (fileData.foreign)
+            return;
 
         string outPath;
-        FileUtil::getParts(outPath, outFmt.c_str(), filePath);
-        bool toStdout = (outPath == "-");
+        pathFormat.format(outPath, filePath);
+        result.toStdout = (outPath == "-");
 
-        if (updates.empty() && ! toStdout) {
-            cerr << "No updates to: " << outPath << std::endl;
-            continue;
+        if (updates.empty() && ! result.toStdout) {
+            log.push_back(Diagnostic{ DIAG_OUTPUT, filePath, "", "No updates to: " + outPath });
+            return;
         }
 
-        ostream* pOut = &cout;
-        ofstream outF;
-        if (! toStdout) {
-            outF.open(outPath);
-            if (! outF) {
-                cerr << "Failed creation of: " << outPath << " outFmt: " << outFmt << " filePath: " << filePath << std::endl;
-                continue;
+        renderRows(result.rows, fileData);
+        if (! result.toStdout) {
+            // Replaced whole, unless a resumed run finds it already written.
+            if (journal == nullptr || ! journal->written(outPath, result.rows)) {
+                if (! dirMaker.makeParents(outPath)
+                        || ! FileUtil::writeAtomic(outPath, result.rows.data(), result.rows.size())) {
+                    log.push_back(Diagnostic{ DIAG_ERROR, filePath, "",
+                        "Failed creation of: " + outPath + " outFmt: " + outFmt + " filePath: " + filePath });
+                    result.rows.clear();
+                    return;
+                }
+                if (journal != nullptr)
+                    journal->wrote(outPath, result.rows);
             }
-            pOut = &outF;
-            cerr << "Saved " << updates.size() << " updates to: " << outPath << endl;
-        } else if (verbose) {
-            cout << "\n==== File: " << filePath << endl;
+            result.rows.clear();
+            log.push_back(Diagnostic{ DIAG_OUTPUT, filePath, "",
+                "Saved " + to_string(updates.size()) + " updates to: " + outPath });
         }
 
         if (verbose) {
             for (const auto& upd : updates) {
-                cerr << "   Update: [" << upd.first << "]=" << upd.second << " To:" << xmlData.at(upd.first) << std::endl;
+                log.push_back(Diagnostic{ DIAG_INFO, filePath, upd.first,
+                    "   Update: [" + upd.first + "]=" + (upd.second.cleared ? "" : upd.second.statement.str()) + " To:" + fileData.data.at(upd.first).statement.str() });
             }
         }
 
-        for (const string& key : fileRow) {
-            const string& str = (key.compare(0, sizeStr(META_PREFIX), META_PREFIX) == 0)
-                ? xmlMeta.at(key)
-                : xmlData.at(key);
-            (*pOut) << str;
+    };
+
+    size_t threadCnt = std::min((size_t)parseThreads, files.size());
+    if (threadCnt > 1) {
+        atomic<size_t> nextFile(0);
+        vector<thread> threads;
+        for (size_t idx = 0; idx < threadCnt; idx++) {
+            threads.push_back(thread([&]() {
+                PerfCounters::Scope scope(perf, PerfCounters::WRITE);
+                size_t fileIdx;
+                while ((fileIdx = nextFile++) < files.size()) {
+                    writeFile(fileIdx);
+                }
+            }));
+        }
+        for (thread& worker : threads) {
+            worker.join();
+        }
+    } else {
+        for (size_t idx = 0; idx < files.size(); idx++) {
+            writeFile(idx);
         }
+    }
 
-        if (outF.is_open())
-            outF.close();
+    for (size_t idx = 0; idx < files.size(); idx++) {
+        const WriteResult& result = results[idx];
+        diag.order = Diagnostics::OUTPUT_ORDER + idx;
+        if (result.toStdout && verbose) {
+            diag.flush();
+            cout << "\n==== File: " << files[idx]->first << endl;
+        }
+        for (const Diagnostic& msg : result.log) {
+            diag.report(msg);
+        }
+        if (! result.rows.empty()) {
+            diag.flush();
+            cout << result.rows;
+        }
     }
 }
 
+// -------------------------------------------------------------------------------------------------
+// Key by file matrix, one row per key and a column per file in filesData. The data maps are
+// already sorted by key, so rows are merged from one cursor per file and streamed out,
+// memory is one row no matter how many keys and files. Cells hold the decoded value text.
+void XmlBuffer::writeCsv(Diagnostics& diag, const string& csvPath) const {
+    if (csvPath.length() == 0) {
+        return;
+    }
+
+    CsvWriter csv(CsvWriter::separatorFor(csvPath));
+    if (csvPath == "-") {
+        diag.flush();
+    }
+    if (! csv.open(csvPath)) {
+        diag.report(DIAG_ERROR, csvPath, "", "Failed creation of: " + csvPath);
+        return;
+    }
+
+    vector<XmlData::const_iterator> cursors;
+    vector<XmlData::const_iterator> ends;
+    vector<bool> jsonCols;
+    csv.field("key");
+    for (const auto& file : filesData) {
+        if (file.second.foreign)
+            continue;
+        csv.field(file.first);
+        jsonCols.push_back(file.second.json);
+        cursors.push_back(file.second.data.begin());
+        ends.push_back(file.second.data.end());
+    }
+    csv.endRow();
+
+    size_t rows = 0;
+    string text;
+    for (;;) {
+        const string* key = nullptr;
+        for (size_t idx = 0; idx < cursors.size(); idx++) {
+            if (cursors[idx] != ends[idx] && (key == nullptr || cursors[idx]->first < *key))
+                key = &cursors[idx]->first;
+        }
+        if (key == nullptr)
+            break;
+
+        const string rowKey = *key;     // cursors move past it
+        csv.field(rowKey);
+        for (size_t idx = 0; idx < cursors.size(); idx++) {
+            if (cursors[idx] != ends[idx] && cursors[idx]->first == rowKey) {
+                valueText(jsonCols[idx], cursors[idx]->second.statement, text);
+                csv.field(text);
+                ++cursors[idx];
+            } else {
+                csv.field("", 0);
+            }
+        }
+        csv.endRow();
+        rows++;
+    }
 
+    if (csv.close()) {
+        diag.report(DIAG_OUTPUT, csvPath, "", "Saved " + to_string(rows) + " keys of "
+            + to_string(cursors.size()) + " files to: " + csvPath);
+    } else {
+        diag.report(DIAG_ERROR, csvPath, "", "Failed writing: " + csvPath);
+    }
+}
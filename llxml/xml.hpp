@@ -1,6 +1,6 @@
 //-------------------------------------------------------------------------------------------------
 //
-// File: json.hpp  Author: Dennis Lang  Desc: Parse json
+// File: xml.hpp  Author: Dennis Lang  Desc: Parse xml and json resources
 //
 //-------------------------------------------------------------------------------------------------
 //
@@ -37,6 +37,7 @@
 //
 //   </resources>
 //
+// Json resources (json.hpp) are scanned into the same FileData, so either format updates the other.
 //
 // ----- License ----
 //
@@ -65,44 +66,175 @@
 #include <vector>
 #include <exception>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <ostream>
 #include <regex>
+#include <memory>
+#include <stdint.h>
 
 #include "lstring.hpp"
+#include "diagnostics.hpp"
+#include "keyfilter.hpp"
+#include "shard.hpp"
+#include "stringpool.hpp"
 
 using namespace std;
 
 typedef vector<lstring> StringList;
 typedef vector<string> Strings;
-typedef map<string, string> XmlData;
+
+// Statement and hash of its white space normalized form, computed once when scanned.
+struct XmlValue {
+    PooledText statement;   // equal statements of all files share one copy
+    uint64_t hash = 0;
+    bool cleared = false;   // xml master value not set by a child, statement keeps only its tags
+};
+typedef map<string, XmlValue> XmlData;
+typedef unordered_set<const string*> XmlKeys;   // shared key strings
+
+// Rows [begRow, endRow) of a BEGIN NAMESPACE to END NAMESPACE section, markers included.
+struct XmlRange {
+    string name;
+    size_t begRow;
+    size_t endRow;          // begRow while END is not found yet
+};
 
 struct FileData {
     Strings rows;
     XmlData meta;
     XmlData data;
     XmlData updates;
-    XmlData extra;
+    XmlKeys extra;          // child keys not in this file
+    vector<XmlRange> namespaces;
+    bool json = false;      // data values are json string literals
+    bool foreign = false;   // master of another -shard, only its keys and cleared values are used
+};
+
+// Namespaces selected with -namespace. A name is selected if it matches an include pattern,
+// or there are none, and no exclude pattern. Entries outside any namespace are selected
+// only if there are no include patterns.
+struct XmlNamespaceFilter {
+    vector<std::regex> include;
+    vector<std::regex> exclude;
+
+    bool empty() const { return include.empty() && exclude.empty(); }
+    bool selected(const string& name) const;
+};
+
+// Statement found by scanning, applied to FileData in buffer order.
+struct XmlItem {
+    string key;             // data key, empty for meta
+    XmlValue value;
+    const char* beg = nullptr;  // statement span in scanned buffer
+    const char* end = nullptr;
+    bool lazy = false;      // value not yet copied from span
+    string error;           // diagnostic reported when item is applied
+    Strings duplicates;     // masters updated with a different value, reported after the item
+    string nsMark;          // namespace of a BEGIN or END NAMESPACE comment
+    bool nsBegin = false;
+    bool nsEnd = false;     // both for a skipped section
+    unsigned skip = 0;      // row numbers consumed without adding a row
+    size_t keyHash = 0;     // selects the update shard of a child item
+    bool isMeta = true;
+    bool json = false;      // scanned from a json resource
+    bool abort = false;     // unknown statement, stop parsing
+    bool applied = false;   // child item already updated on a shard thread
+    bool updated = false;
+};
+typedef vector<XmlItem> XmlItems;
+
+// Master data entry holding a key, fileIdx is the position in filesData.
+struct XmlHolder {
+    size_t fileIdx;
+    XmlData::iterator iter;
+};
+typedef unordered_map<string, vector<XmlHolder>> XmlIndex;
+
+// Updates and extras collected by one key shard, merged into the masters when all shards are done.
+struct XmlShard {
+    vector<XmlData> updates;        // per master file
+    vector<XmlKeys> extra;
+    vector<unsigned> newUpdates;    // per child, entries not yet in the masters
+    vector<unsigned> newExtras;
+};
+
+struct XmlFile;
+class Archive;
+class Journal;
+class PerfCounters;
+
+// Line count up to an offset of the buffer, later offsets count on from it.
+struct LineCursor {
+    size_t pos = 0;
+    unsigned int line = 0;
 };
 
 // String buffer being parsed
 class XmlBuffer : public std::vector<char> {
 public:
     map<string, FileData> filesData;
+    unsigned parseThreads = 1;
+    const XmlNamespaceFilter* nsFilter = nullptr;   // nullptr selects all
+    const KeyFilter* keyFilter = nullptr;
+    const ShardSpec* shard = nullptr;               // nullptr owns all masters
+    PerfCounters* perf = nullptr;                   // -perfcounters
+    bool intern = false;    // -intern, equal master values share one pooled copy
+    bool json = false;      // buffer holds a json resource
 
-    bool parse(ostream& err, string filePath, bool append);
+    bool parse(Diagnostics& diag, string filePath, bool append);
     void clearData();
-    void writeFilesTo(const string& outPathFmt, bool verbose) const;
+    void writeFilesTo(Diagnostics& diag, const string& outPathFmt, bool verbose, Journal* journal = nullptr) const;
+    void writeCsv(Diagnostics& diag, const string& csvPath) const;
     unsigned int getUpdates() const;
     unsigned int getExtras() const;
+    void reportKeys(Diagnostics& diag) const;
+
+    // Merged filesData for the journal, loadState is false and leaves no files if data is short.
+    void saveState(ostream& out) const;
+    bool loadState(const char*& ptr, const char* end);
+
+    void scanFile(XmlItems& items, bool master) const;
+    void updateChildren(vector<XmlFile>& children);
+    bool applyFile(Diagnostics& diag, XmlFile& file);
 
 private:
-    size_t pos = 0;
-    const char* getNext(const regex& xmlPatBeg) const;
-    bool getStatement(const regex& xmlPatEnd, string& outStatement) const;
+    vector<map<string, FileData>::iterator> fileList;
+    XmlIndex keyIndex;
+
+    const char* getNext(size_t& pos, size_t end) const;
+    bool getStatement(const char* tail, size_t& pos, size_t end, size_t* missFrom = nullptr) const;
+    bool skipNamespace(const string& name, size_t& pos, size_t end) const;
+    bool scan(size_t& pos, size_t end, XmlItems& items, bool lazy) const;
+    bool scanChunks(XmlItems& items, bool lazy) const;
+    bool scanJson(size_t& pos, size_t end, XmlItems& items, bool lazy) const;    // json.cpp
+    const XmlValue& getValue(XmlItem& item) const;
+    const XmlValue& masterValue(XmlItem& item, const XmlValue& curValue, bool json, XmlValue& converted) const;
+    void getChunkCuts(vector<size_t>& cuts, size_t chunkLen) const;
+    bool apply(Diagnostics& diag, const string& filePath, bool master, XmlItems& items);
+
+    void buildIndex();
+    bool update(XmlItem& item, XmlShard* shard, size_t childIdx);
+    unsigned int lineAt(size_t pos, LineCursor& cursor) const;
+};
 
-    bool update(const string& key, const string& statement);
-    unsigned int lineAt(size_t pos) const;
+// File read and scanned on pipeline threads, applied in command line order.
+struct XmlFile {
+    size_t seq = 0;         // command line order
+    size_t input = 0;       // traversal number, orders diagnostics of a -shard
+    string filePath;
+    bool master = false;
+    std::shared_ptr<const Archive> archive;     // file is entryIdx of archive
+    size_t entryIdx = 0;
+    XmlBuffer buffer;
+    XmlItems items;
+    string log;             // read diagnostics, reported before the items
+    bool found = false;     // file exists
+    bool read = false;
+    unsigned updates = 0;   // updates and extras added to the masters
+    unsigned extras = 0;
+    uint32_t crc = 0;       // content crc32, with -journal
 };
 
 